@@ -1,4 +1,6 @@
 #include "../sdk.h"
+#include <latch>
+#include <boost/asio/post.hpp>
 #include "app.h"
 
 namespace app {
@@ -79,7 +81,7 @@ UseCaseJoinGame::UseCaseJoinGame(model::Game::Ptr game, Players::Ptr players, bo
 }
 
 
-JoinGameResult UseCaseJoinGame::RunUseCase(const std::string &name, const model::Map::Id& mapId)
+JoinGameResult UseCaseJoinGame::RunUseCase(const std::string &name, const model::Map::Id& mapId, model::GameSession* session)
 {
     //
     //  Если было передано пустое имя игрока, должен вернуться ответ со статус-кодом 400 Bad request
@@ -89,35 +91,34 @@ JoinGameResult UseCaseJoinGame::RunUseCase(const std::string &name, const model:
         throw Error(http::status::bad_request, ErrorReason::INVALID_NAME);
     }
 
-    const auto *map = game_->FindMap(mapId);
-
     //
     //  Если в качестве mapId указан несуществующий id карты,
     //  должен вернуться ответ со статус-кодом 404 Not found
     //
-    if (!map) {
+    if (!game_->FindMap(mapId)) {
         throw Error(http::status::not_found, ErrorReason::MAP_NOT_FOUND);
     }
 
-    auto *session = game_->FindSession(mapId);
-
     //
     //  На самом деле такого не должно быть никогда - это какая-то 
     //  серьезная логическая ошибка
     //
-    if (!session) {
-        if ((session = game_->AddSession(*map)) == nullptr) {
-            throw Error(http::status::not_found, ErrorReason::MAP_NOT_FOUND);
-        }
+    if (!session || session->GetMap().GetId() != mapId) {
+        throw Error(http::status::not_found, ErrorReason::MAP_NOT_FOUND);
     }
 
-    auto *dog = session->AddDog(name, randomize_spawn_points_);
+    auto dog = session->AddDog(name, randomize_spawn_points_);
 
     Token token = PlayerTokens::MakeToken();
 
-    players_->AddPlayer(token, *session, dog->GetId());
+    players_->AddPlayer(token, *session, dog.GetId());
+
+    //
+    //  новый игрок должен сразу появиться в списке игроков и в состоянии
+    //
+    session->PublishSnapshot();
 
-    return {token, dog->GetId()};
+    return {token, dog.GetId()};
 }
 
 
@@ -130,27 +131,16 @@ UseCasePlayers::UseCasePlayers(Players::Ptr players)
 
 PlayersResult UseCasePlayers::RunUseCase(const Token& token)
 {
-    PlayersResult result;
+    const auto *session = players_->FindSession(token);
 
-    auto *myself = players_->FindPlayer(token);
-
-    if (!myself) {
+    if (!session) {
         throw Error(http::status::unauthorized, ErrorReason::UNKNOWN_TOKEN);
     }
 
-    const auto &players = players_->GetPlayers();
-    const auto &mymap = myself->GetMap();
-
-    for (const auto& player : players) {
-        //
-        //  Получить список игроков, находящихся в одной (!!!) игровой сессии с игроком
-        //
-        if (mymap == player.GetMap()) {
-            result.emplace_back(std::make_pair(player.GetId(), player.GetName()));
-        }
-    }
-
-    return result;
+    //
+    //  Получить список игроков, находящихся в одной (!!!) игровой сессии с игроком
+    //
+    return session->GetSnapshot()->players;
 }
 
 
@@ -162,40 +152,28 @@ UseCaseState::UseCaseState(Players::Ptr players)
 
 }
 
-StateResult UseCaseState::RunUseCase(const Token& token)
+StateResult UseCaseState::RunUseCase(const Token& token, std::optional<model::SessionSnapshot::Generation> since)
 {
-    StateResult result;
-
-    auto *myself = players_->FindPlayer(token);
+    const auto *session = players_->FindSession(token);
 
-    if (!myself) {
+    if (!session) {
         throw Error(http::status::unauthorized, ErrorReason::UNKNOWN_TOKEN);
     }
 
-    const auto &session = myself->GetSession();
-
     //
-    //  Собираю в массив всех собак - игроков
+    //  Собаки и трофеи на момент последнего тика
     //
-    const auto &dogs = session.GetDogs();
-    for (const auto& dog : dogs) {
-        result.players.emplace_back(
-            std::make_tuple(dog.GetId(), dog.GetPos(), dog.GetSpeed(), dog.GetDir(), dog.GetBag(), dog.GetScore())
-        );
-    }
+    StateResult result{session->GetSnapshot(), nullptr};
 
     //
-    //  Затем все трофеи
+    //  Снимок, с которого нужны изменения. Если он уже выпал из истории
+    //  (или номер вообще из будущего) - игрок получит полное состояние
     //
-    const auto &loots = session.GetLoots();
-    for (const auto& loot : loots) {
-        result.loots.emplace_back(
-            std::make_tuple(loot.GetId(), loot.GetType(), loot.GetPos())
-        );
+    if (since && *since <= result.snapshot->generation) {
+        result.base = session->FindSnapshot(*since);
     }
 
     return result;
-
 }
 
 
@@ -209,13 +187,15 @@ UseCaseAction::UseCaseAction(Players::Ptr players)
 
 void UseCaseAction::RunUseCase(const Token& token, model::Dog::Direction dir) {
 
-    auto* player = players_->FindPlayer(token);
-    if  (!player) {
+    switch (players_->PostAction(token, dir)) {
+    case Players::ActionResult::Posted:
+        break;
+    case Players::ActionResult::UnknownToken:
         throw Error(http::status::unauthorized, ErrorReason::UNKNOWN_TOKEN);
+    case Players::ActionResult::QueueFull:
+        throw Error(http::status::service_unavailable, ErrorReason::SERVER_BUSY);
     }
 
-    player->ChangeDir(dir);
-
 }
 
 
@@ -227,65 +207,13 @@ UseCaseTick::UseCaseTick(model::Game::Ptr game, Players::Ptr players)
 , players_(players) {
 }
 
-std::vector<geom::Item> OfficesToItems(const model::Map::Offices& offices) {
-
-    std::vector<geom::Item> items;
-
-    for (const auto& office : offices) {
-        items.emplace_back(
-            geom::Item{{static_cast<double>(office.GetPosition().x), static_cast<double>(office.GetPosition().y)}, office.WIDTH, 0}
-        );
-    }
-
-    // std::transform(offices.cbegin(), offices.cend(),
-    //     std::back_inserter(items),
-    //     [](const auto& office) { 
-    //         return geom::Item{{static_cast<double>(office.GetPosition().x), static_cast<double>(office.GetPosition().y)}, office.WIDTH, 0}; 
-    //     }
-    // );
-
-    return items;
-
-}
-
-std::vector<geom::Item>& operator+=(std::vector<geom::Item>& left, std::vector<geom::Item>&& right) {
-    left.insert(left.end(), right.begin(), right.end());
-    return left;
-}
-
-void UseCaseTick::RunUseCase(model::TimeInterval timeDelta) {
-
-    const auto &maps = game_->GetMaps();
-
-    for (const auto& map : maps) {
-        
-        auto* session = game_->FindSession(map.GetId());
-        if ( !session ) {
-            continue; // вообще-то это треш какой-то
-        }
-
-        //
-        //  Сначала генерирую потерянные вещи, затем двигаю собак
-        //
-        auto items = session->GenerateLoots(timeDelta);
-        auto gatherers = session->MoveDogs(timeDelta);
-
-        //
-        //  Добавить к элементам офисы
-        //
-        items += OfficesToItems(map.GetOffices());
-
-        //
-        //  Создать провайдер вещей и сборщиков
-        //
-        model::LootGathererProvider gp(std::move(items), std::move(gatherers));
-
-        //
-        //  Собрать трофеи, посчитать статистику
-        //
-        session->GatherLoots(gp);
-    }
+void UseCaseTick::RunUseCase(model::GameSession& session, model::TimeInterval timeDelta) {
 
+    //
+    //  Сгенерировать трофеи, подвинуть собак, собрать трофеи и посчитать
+    //  статистику - офисы и трофеи уже лежат в мире столкновений сессии
+    //
+    session.Tick(timeDelta);
 }
 
 
@@ -309,19 +237,16 @@ RecordsResult UseCaseRecords::RunUseCase(int start, int maxItems) {
 //  "Приложение" - общий интерфейс ко всем сценариям игры
 //
 
-//  Пока делаю блокировку мьютексом - позже посмотрю boost::asio::strand
-#define LOCK_GAME_STATE()   \
-    std::lock_guard _guard(game_state_lock_)
-
 // открытый конструктор для использования без лишних параметров
-Application::Application(model::Game::Ptr game, postgres::Database& db, bool randomize_spawn_points)
-: Application(game, std::make_shared<app::Players>(), db, randomize_spawn_points) {
+Application::Application(model::Game::Ptr game, postgres::Database& db, bool randomize_spawn_points, unsigned workers_count)
+: Application(game, std::make_shared<app::Players>(), db, randomize_spawn_points, workers_count) {
 
 }
 
 // закрытый конструктор
-Application::Application(model::Game::Ptr game, Players::Ptr players, postgres::Database& db, bool randomize_spawn_points)
-: players_(players)
+Application::Application(model::Game::Ptr game, Players::Ptr players, postgres::Database& db, bool randomize_spawn_points, unsigned workers_count)
+: game_(game)
+, players_(players)
 , use_case_maps_list_(game)
 , use_case_map_info_(game)
 , use_case_join_game_(game, players, randomize_spawn_points)
@@ -331,9 +256,17 @@ Application::Application(model::Game::Ptr game, Players::Ptr players, postgres::
 , use_case_tick_(game, players)
 , use_case_records_(db)
 , dogs_collector_(game, players, db)
+, workers_(std::max(1u, workers_count))
 {
 }
 
+Application::~Application() {
+    //
+    //  дождаться уже отправленных в пул задач, пока все, что им нужно, еще живо
+    //
+    workers_.join();
+}
+
 void Application::AddListener(ApplicationListener::Ptr listener)
 {
     listeners_.emplace_back(std::move(listener));
@@ -355,45 +288,72 @@ const model::Map& Application::GetMap(const model::Map::Id &id)
 
 RecordsResult Application::GetRecords(int start, int maxItems)
 {
-    LOCK_GAME_STATE();
     return use_case_records_.RunUseCase(start, maxItems);
 }
 
+//
+//  Вход в игру выполняется в strand сессии карты (см. FindStrand),
+//  остальные запросы игрока берут данные из снимка сессии или кладут
+//  команду в ее очередь и strand не требуют
+//
+
 JoinGameResult Application::JoinGame(const std::string &name, const model::Map::Id& mapId)
 {
-    LOCK_GAME_STATE();
-    return use_case_join_game_.RunUseCase(name, mapId);
+    //
+    //  Место в сессии уже занято в FindStrand; если JoinGame вызван
+    //  не из strand сессии этой карты - занимаю место сам
+    //
+    auto* session = FindCurrentSession(mapId);
+    if (!session) {
+        session = game_->TakeSeat(mapId);
+    }
+
+    try {
+        return use_case_join_game_.RunUseCase(name, mapId, session);
+    }
+    catch (...) {
+        if (session) {
+            game_->FreeSeat(*session);
+        }
+        throw;
+    }
 }
 
 PlayersResult Application::GetPlayers(const Token &token)
 {
-    LOCK_GAME_STATE();
     return use_case_players_.RunUseCase(token);
 }
 
-StateResult Application::GetState(const Token &token)
+StateResult Application::GetState(const Token &token, std::optional<model::SessionSnapshot::Generation> since)
 {
-    LOCK_GAME_STATE();
-    return use_case_state_.RunUseCase(token);
+    return use_case_state_.RunUseCase(token, since);
 }
 
 void Application::RotateDog(const Token &token, model::Dog::Direction dir)
 {
-    LOCK_GAME_STATE();
     use_case_action_.RunUseCase(token, dir);
 }
 
 void Application::Tick(model::TimeInterval timeDelta)
 {
-    LOCK_GAME_STATE();
-    
-    use_case_tick_.RunUseCase(timeDelta);
-
     //
-    //  Некоторые игроки - собаки могли покинуть игру,
-    //  нужно их удалить
+    //  Тик каждой сессии выполняется в ее strand, сессии тикают параллельно
     //
-    dogs_collector_.CollectRetiredDogs();
+    ForEachSession([this, timeDelta](model::GameSession& session) {
+
+        use_case_tick_.RunUseCase(session, timeDelta);
+
+        //
+        //  Некоторые игроки - собаки могли покинуть игру,
+        //  нужно их удалить
+        //
+        dogs_collector_.CollectRetiredDogs(session);
+
+        //
+        //  и отдать читателям новое состояние сессии
+        //
+        session.PublishSnapshot();
+    });
 
     //
     //  После выполнения use case еще делаю опциональные операции,
@@ -405,12 +365,82 @@ void Application::Tick(model::TimeInterval timeDelta)
     }
 }
 
+std::optional<Application::Strand> Application::FindStrand(const model::Map::Id& mapId) {
+
+    if (auto* session = game_->TakeSeat(mapId)) {
+        return GetStrand(*session);
+    }
+
+    return std::nullopt;
+}
+
+Application::Strand Application::GetStrand(const model::GameSession& session) {
+
+    std::lock_guard lock(strands_lock_);
+
+    auto it = strands_.find(&session);
+    if (it == strands_.end()) {
+        it = strands_.emplace(&session, boost::asio::make_strand(workers_.get_executor())).first;
+    }
+
+    return it->second;
+}
+
+model::GameSession* Application::FindCurrentSession(const model::Map::Id& mapId) {
+
+    std::lock_guard lock(strands_lock_);
+
+    for (const auto& [session, strand] : strands_) {
+        if (session->GetMap().GetId() == mapId && strand.running_in_this_thread()) {
+            return const_cast<model::GameSession*>(session);
+        }
+    }
+
+    return nullptr;
+}
+
+void Application::ForEachSession(const SessionHandler& handler) {
+
+    auto sessions = game_->GetSessions();
+
+    if (sessions.empty()) {
+        return;
+    }
+
+    //
+    //  Исключение из любой сессии пробрасываю дальше,
+    //  но только после того, как закончатся все
+    //
+    std::vector<std::exception_ptr> errors(sessions.size());
+    std::latch done(static_cast<std::ptrdiff_t>(sessions.size()));
+
+    for (size_t idx = 0; idx < sessions.size(); ++idx) {
+        boost::asio::post(GetStrand(*sessions[idx]), [&handler, &errors, &done, &sessions, idx]() noexcept {
+            try {
+                handler(*sessions[idx]);
+            }
+            catch (...) {
+                errors[idx] = std::current_exception();
+            }
+            done.count_down();
+        });
+    }
+
+    done.wait();
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
 //
 //  Функция нужна только для сериализации
 //
-Players::Pairs Application::GetTokensPlayers() const 
+Players::Pairs Application::GetTokensPlayers(const model::GameSession& session) const 
 {
-    return players_->GetPairs();
+    return players_->GetPairs(session);
 }
 
-} // namespace app
\ No newline at end of file
+} // namespace app
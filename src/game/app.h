@@ -1,6 +1,12 @@
 #pragma once
 #include <string_view>
 #include <optional>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/beast/http/status.hpp>
 
 #include "model.h"
@@ -24,6 +30,7 @@ struct ErrorReason {
     constexpr static std::string_view INVALID_NAME = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Invalid name\"\n}"sv;
     constexpr static std::string_view PARSE_ERROR = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Join game request parse error\"\n}"sv;
     constexpr static std::string_view UNKNOWN_TOKEN = "{\n\"code\": \"unknownToken\",\n\"message\": \"Player token has not been found\"\n}"sv;
+    constexpr static std::string_view SERVER_BUSY = "{\n\"code\": \"serverBusy\",\n\"message\": \"Too many actions, try again later\"\n}"sv;
 };
 
 class Error : public std::exception
@@ -55,26 +62,20 @@ struct JoinGameResult
     Player::Id id;
 };
 
-using PlayersResult = std::vector<std::pair<Player::Id, std::string>>;
-
+//
+//  Списки игроков и состояние сессии отдаются из ее последнего снимка
+//  (см. model::SessionSnapshot) - без копирования и без блокировок
+//
+using PlayersResult = std::shared_ptr<const model::SessionSnapshot::Players>;
 
+//
+//  Состояние сессии: последний снимок и, если игрок просил изменения
+//  с какого-то снимка и этот снимок еще в истории сессии, - он сам (base).
+//  Если base нет, отдается полное состояние
+//
 struct StateResult {
-    using Players = std::vector<std::tuple<model::Dog::Id, geom::Point2D, geom::Vec2D, model::Dog::Direction, model::Dog::Bag, model::Dog::Score>>;
-    using Loots = std::vector<std::tuple<model::Loot::Id, model::Loot::Type, geom::Point2D>>;
-
-    static constexpr size_t DogId = 0;
-    static constexpr size_t DogPos = 1;
-    static constexpr size_t DogSpeed = 2;
-    static constexpr size_t DogDir = 3;
-    static constexpr size_t DogBag = 4;
-    static constexpr size_t DogScore = 5;
-
-    static constexpr size_t LootId = 0;
-    static constexpr size_t LootType = 1;
-    static constexpr size_t LootPos = 2;
-
-    Players players;
-    Loots loots;
+    model::SessionSnapshot::Ptr snapshot;
+    model::SessionSnapshot::Ptr base;
 };
 
 using RecordsResult = std::vector<PlayerStatistics>;
@@ -119,7 +120,10 @@ class UseCaseJoinGame {
 public:
     UseCaseJoinGame(model::Game::Ptr game, Players::Ptr players, bool randomize_spawn_points);
 
-    JoinGameResult RunUseCase(const std::string &name, const model::Map::Id& mapId);
+    //
+    //  session - сессия карты, в которой для игрока уже занято место (см. model::Game::TakeSeat)
+    //
+    JoinGameResult RunUseCase(const std::string &name, const model::Map::Id& mapId, model::GameSession* session);
 
 private:
     model::Game::Ptr game_;
@@ -128,7 +132,7 @@ private:
 };
 
 //
-//  Список игроков 
+//  Список игроков (из снимка сессии - сценарий можно выполнять в любом потоке)
 //
 class UseCasePlayers {
 public:
@@ -142,19 +146,22 @@ private:
 
 //
 //  Состояние игры (игроки, их координаты, находки, счет каждого игрока и т.д.)
+//  из снимка сессии - сценарий можно выполнять в любом потоке
 //
 class UseCaseState {
 public:
     explicit UseCaseState(Players::Ptr players);
 
-    StateResult RunUseCase(const Token& token);
+    StateResult RunUseCase(const Token& token, std::optional<model::SessionSnapshot::Generation> since);
 
 private:
     Players::Ptr players_;
 };
 
 //
-//  Смена направления движения игрока (его собаки)
+//  Смена направления движения игрока (его собаки): команда кладется
+//  в очередь сессии и применяется на ближайшем тике, поэтому сценарий
+//  можно выполнять в любом потоке, не дожидаясь strand сессии
 //
 class UseCaseAction {
 public:
@@ -167,13 +174,13 @@ private:
 };
 
 //
-//  Увеличение игрового времени на delta time
+//  Увеличение игрового времени на delta time в одной сессии
 //
 class UseCaseTick {
 public:
     UseCaseTick(model::Game::Ptr game, Players::Ptr players);
 
-    void RunUseCase(model::TimeInterval timeDelta);
+    void RunUseCase(model::GameSession& session, model::TimeInterval timeDelta);
 
 private:
     model::Game::Ptr game_;
@@ -214,29 +221,60 @@ public:
 //
 //  "Приложение" - паттерн Фасад который предоставляет единый интерфейс ко всем игровым сценариям
 //
+//  Сессии никак не связаны друг с другом, поэтому у каждой сессии свой strand
+//  в общем пуле потоков: все, что трогает сессию (запросы ее игроков, вход
+//  в игру, тик), выполняется только в этом strand, и запросы к разным сессиям
+//  друг друга не ждут
+//
 class Application {
 public:
     using Ptr = std::shared_ptr<Application>;
+    using Strand = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+    using SessionHandler = std::function<void(model::GameSession&)>;
 
-    Application(model::Game::Ptr game, postgres::Database& db, bool randomize_spawn_points);
+    Application(model::Game::Ptr game, postgres::Database& db, bool randomize_spawn_points,
+                unsigned workers_count = std::thread::hardware_concurrency());
+    ~Application();
 
     const model::Game::Maps &GetMaps();
     const model::Map &GetMap(const model::Map::Id &id);
     JoinGameResult JoinGame(const std::string &name, const model::Map::Id& mapId);
     PlayersResult GetPlayers(const Token &token);
-    StateResult GetState(const Token &token);
+    StateResult GetState(const Token &token, std::optional<model::SessionSnapshot::Generation> since = std::nullopt);
     RecordsResult GetRecords(int start, int maxItems);
     void RotateDog(const Token &token, model::Dog::Direction dir);
     void Tick(model::TimeInterval timeDelta);
     void AddPlayer(Token token, Player&& player);
     void AddListener(ApplicationListener::Ptr listener);
-    Players::Pairs GetTokensPlayers() const; // нужно только для сериализации
+    Players::Pairs GetTokensPlayers(const model::GameSession& session) const; // нужно только для сериализации
+
+    //
+    //  strand сессии, в котором выполняется вход в игру на карту mapId.
+    //  Сессия карты выбирается здесь же, и в ней сразу занимается место -
+    //  JoinGame, вызванный затем в этом strand, добавит собаку именно в эту
+    //  сессию. Если карты нет - запрос все равно завершится ошибкой
+    //  и strand ему не нужен
+    //
+    std::optional<Strand> FindStrand(const model::Map::Id& mapId);
+
+    //
+    //  выполнить handler для каждой сессии в ее strand и дождаться, пока
+    //  все закончат; вызывать только вне strand сессий
+    //
+    void ForEachSession(const SessionHandler& handler);
 
 private:
     // конструктор, который создает временные параметры, которые нужны только на момент создания объекта
-    Application(model::Game::Ptr game, Players::Ptr players, postgres::Database& db, bool randomize_spawn_points);
+    Application(model::Game::Ptr game, Players::Ptr players, postgres::Database& db, bool randomize_spawn_points, unsigned workers_count);
+
+    Strand GetStrand(const model::GameSession& session);
 
-    std::mutex                game_state_lock_;
+    //
+    //  сессия карты mapId, в strand которой выполняется текущий поток
+    //
+    model::GameSession* FindCurrentSession(const model::Map::Id& mapId);
+
+    model::Game::Ptr          game_;
     Players::Ptr              players_;
     use_case::UseCaseMapsList use_case_maps_list_;
     use_case::UseCaseMapInfo  use_case_map_info_;
@@ -248,6 +286,13 @@ private:
     use_case::UseCaseRecords  use_case_records_;
     collector::DogsCollector  dogs_collector_;
     ApplicationListener::List listeners_;
+
+    //
+    //  strand-ы ссылаются на пул, поэтому удаляются раньше него
+    //
+    boost::asio::thread_pool  workers_;
+    std::mutex                strands_lock_;
+    std::unordered_map<const model::GameSession*, Strand> strands_;
 };
 
 } // namespace app
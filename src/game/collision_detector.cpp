@@ -1,5 +1,11 @@
 #include "../sdk.h"
 #include <cassert>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GEOM_X86_SIMD 1
+#endif
 
 #include "collision_detector.h"
 
@@ -37,55 +43,614 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
     return CollectionResult(sq_distance, proj_ratio);
 }
 
-std::vector<GatheringEvent> FindGatherEvents(
-    const ItemGathererProvider& provider) {
+namespace {
+
+//
+//  Начиная с какого числа предметов поиск идет через сетку
+//
+constexpr size_t GRID_MIN_ITEMS = 16;
+
+//
+//  учитывайте перемещение на любое ненулевое расстояние — погрешностью можно пренебречь
+//
+bool IsSamePoint(geom::Point2D p1, geom::Point2D p2) {
+    return p1.x == p2.x && p1.y == p2.y;
+}
+
+//
+//  Проверить пару "сборщик - предмет" и, если есть пересечение, добавить событие
+//
+void TryGatherItem(const Gatherer& gatherer, const Item& item, std::vector<GatheringEvent>& events) {
+
+    auto collect_result
+        = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+
+    if (collect_result.IsCollected(gatherer.width + item.width)) {
+        events.push_back(GatheringEvent{.item_id = item.id,
+                                        .gatherer_id = gatherer.id,
+                                        .sq_distance = collect_result.sq_distance,
+                                        .time = collect_result.proj_ratio});
+    }
+}
+
+//
+//  Функция возвращает вектор событий, идущих в хронологическом порядке.
+//  Порядок одновременно произошедших событий может быть любым.
+//
+void SortByTime(std::vector<GatheringEvent>& events) {
+    std::sort(events.begin(), events.end(),
+              [](const GatheringEvent& e_l, const GatheringEvent& e_r) {
+                  return e_l.time < e_r.time;
+              });
+}
+
+//
+//  Пакетная проверка предметов по одному - она же "эталон" для векторных версий
+//
+size_t TryCollectPointsScalar(Point2D a, Point2D b, double gatherer_width,
+                              const double* xs, const double* ys, const double* widths, size_t count,
+                              CollectionHit* hits) {
+    size_t hits_count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        auto collect_result = TryCollectPoint(a, b, {xs[i], ys[i]});
+        if (collect_result.IsCollected(gatherer_width + widths[i])) {
+            hits[hits_count++] = {i, collect_result};
+        }
+    }
+
+    return hits_count;
+}
+
+//
+//  Сборщик, который движется вдоль оси (а собаки ходят только по горизонтали
+//  или вертикали), задевает предмет, если тот лежит в пределах отрезка по оси
+//  движения и не дальше радиуса от линии движения по другой оси - для такой
+//  проверки не нужны ни скалярные произведения, ни деление. Но на самой
+//  границе округление в ней может разойтись с общей формулой, поэтому это
+//  только грубый отсев с небольшим запасом (AXIS_SLACK): предметы, которые
+//  его прошли, проверяются общей формулой TryCollectPoint + IsCollected,
+//  и результат совпадает с ней в точности
+//
+constexpr double AXIS_SLACK = 1e-6;
+
+struct AxisSweep {
+    AxisSweep(Point2D a, Point2D b, const double* xs, const double* ys) noexcept
+        : along_x(a.y == b.y)
+        , from((along_x ? std::min(a.x, b.x) : std::min(a.y, b.y)) - AXIS_SLACK)
+        , to((along_x ? std::max(a.x, b.x) : std::max(a.y, b.y)) + AXIS_SLACK)
+        , line(along_x ? a.y : a.x)
+        , mains(along_x ? xs : ys)
+        , crosses(along_x ? ys : xs) {
+    }
+
+    bool along_x;
+    double from;
+    double to;
+    double line;
+    const double* mains;
+    const double* crosses;
+};
+
+size_t TryCollectPointsAxisAlignedScalar(Point2D a, Point2D b, double gatherer_width,
+                                         const double* xs, const double* ys, const double* widths, size_t count,
+                                         CollectionHit* hits) {
+
+    const AxisSweep sweep(a, b, xs, ys);
+
+    size_t hits_count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        const double main = sweep.mains[i];
+
+        if (main >= sweep.from && main <= sweep.to
+            && std::abs(sweep.crosses[i] - sweep.line) <= gatherer_width + widths[i] + AXIS_SLACK) {
+            auto collect_result = TryCollectPoint(a, b, {xs[i], ys[i]});
+            if (collect_result.IsCollected(gatherer_width + widths[i])) {
+                hits[hits_count++] = {i, collect_result};
+            }
+        }
+    }
+
+    return hits_count;
+}
+
+#ifdef GEOM_X86_SIMD
+
+//
+//  Векторные версии повторяют TryCollectPoint операция в операцию, без FMA
+//  (для этого файл собирается с -ffp-contract=off, а AVX2 включается без FMA),
+//  поэтому результат побитово совпадает со скалярной версией
+//
+
+__attribute__((target("sse2")))
+size_t TryCollectPointsSse2(Point2D a, Point2D b, double gatherer_width,
+                            const double* xs, const double* ys, const double* widths, size_t count,
+                            CollectionHit* hits) {
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+
+    const __m128d ax = _mm_set1_pd(a.x);
+    const __m128d ay = _mm_set1_pd(a.y);
+    const __m128d vx = _mm_set1_pd(v_x);
+    const __m128d vy = _mm_set1_pd(v_y);
+    const __m128d vlen2 = _mm_set1_pd(v_len2);
+    const __m128d gw = _mm_set1_pd(gatherer_width);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    size_t hits_count = 0;
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128d ux = _mm_sub_pd(_mm_loadu_pd(xs + i), ax);
+        const __m128d uy = _mm_sub_pd(_mm_loadu_pd(ys + i), ay);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(ux, vx), _mm_mul_pd(uy, vy));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(ux, ux), _mm_mul_pd(uy, uy));
+        const __m128d proj = _mm_div_pd(u_dot_v, vlen2);
+        const __m128d sq_dist = _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), vlen2));
+        const __m128d radius = _mm_add_pd(gw, _mm_loadu_pd(widths + i));
+
+        const __m128d collected = _mm_and_pd(
+            _mm_and_pd(_mm_cmpge_pd(proj, zero), _mm_cmple_pd(proj, one)),
+            _mm_cmple_pd(sq_dist, _mm_mul_pd(radius, radius)));
+
+        if (int mask = _mm_movemask_pd(collected); mask != 0) {
+            alignas(16) double proj_lanes[2];
+            alignas(16) double dist_lanes[2];
+            _mm_store_pd(proj_lanes, proj);
+            _mm_store_pd(dist_lanes, sq_dist);
+
+            for (int lane = 0; lane < 2; ++lane) {
+                if (mask & (1 << lane)) {
+                    hits[hits_count++] = {i + lane, {dist_lanes[lane], proj_lanes[lane]}};
+                }
+            }
+        }
+    }
+
+    //
+    //  хвост пакета проверяю по одному
+    //
+    const size_t tail = TryCollectPointsScalar(a, b, gatherer_width, xs + i, ys + i, widths + i, count - i, hits + hits_count);
+    for (size_t h = hits_count; h < hits_count + tail; ++h) {
+        hits[h].index += i;
+    }
+
+    return hits_count + tail;
+}
+
+__attribute__((target("avx2")))
+size_t TryCollectPointsAvx2(Point2D a, Point2D b, double gatherer_width,
+                            const double* xs, const double* ys, const double* widths, size_t count,
+                            CollectionHit* hits) {
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+
+    const __m256d ax = _mm256_set1_pd(a.x);
+    const __m256d ay = _mm256_set1_pd(a.y);
+    const __m256d vx = _mm256_set1_pd(v_x);
+    const __m256d vy = _mm256_set1_pd(v_y);
+    const __m256d vlen2 = _mm256_set1_pd(v_len2);
+    const __m256d gw = _mm256_set1_pd(gatherer_width);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    size_t hits_count = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        const __m256d ux = _mm256_sub_pd(_mm256_loadu_pd(xs + i), ax);
+        const __m256d uy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), ay);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(ux, vx), _mm256_mul_pd(uy, vy));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(ux, ux), _mm256_mul_pd(uy, uy));
+        const __m256d proj = _mm256_div_pd(u_dot_v, vlen2);
+        const __m256d sq_dist = _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), vlen2));
+        const __m256d radius = _mm256_add_pd(gw, _mm256_loadu_pd(widths + i));
+
+        const __m256d collected = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj, zero, _CMP_GE_OQ), _mm256_cmp_pd(proj, one, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_dist, _mm256_mul_pd(radius, radius), _CMP_LE_OQ));
+
+        if (int mask = _mm256_movemask_pd(collected); mask != 0) {
+            alignas(32) double proj_lanes[4];
+            alignas(32) double dist_lanes[4];
+            _mm256_store_pd(proj_lanes, proj);
+            _mm256_store_pd(dist_lanes, sq_dist);
+
+            for (int lane = 0; lane < 4; ++lane) {
+                if (mask & (1 << lane)) {
+                    hits[hits_count++] = {i + lane, {dist_lanes[lane], proj_lanes[lane]}};
+                }
+            }
+        }
+    }
+
+    //
+    //  хвост пакета проверяю по одному
+    //
+    const size_t tail = TryCollectPointsScalar(a, b, gatherer_width, xs + i, ys + i, widths + i, count - i, hits + hits_count);
+    for (size_t h = hits_count; h < hits_count + tail; ++h) {
+        hits[h].index += i;
+    }
+
+    return hits_count + tail;
+}
+
+__attribute__((target("avx2")))
+size_t TryCollectPointsAxisAlignedAvx2(Point2D a, Point2D b, double gatherer_width,
+                                       const double* xs, const double* ys, const double* widths, size_t count,
+                                       CollectionHit* hits) {
+
+    const AxisSweep sweep(a, b, xs, ys);
+
+    const __m256d from = _mm256_set1_pd(sweep.from);
+    const __m256d to = _mm256_set1_pd(sweep.to);
+    const __m256d line = _mm256_set1_pd(sweep.line);
+    const __m256d gw = _mm256_set1_pd(gatherer_width + AXIS_SLACK);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+
+    size_t hits_count = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        const __m256d main = _mm256_loadu_pd(sweep.mains + i);
+        const __m256d cross = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(sweep.crosses + i), line));
+        const __m256d radius = _mm256_add_pd(gw, _mm256_loadu_pd(widths + i));
+
+        const __m256d collected = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(main, from, _CMP_GE_OQ), _mm256_cmp_pd(main, to, _CMP_LE_OQ)),
+            _mm256_cmp_pd(cross, radius, _CMP_LE_OQ));
+
+        if (int mask = _mm256_movemask_pd(collected); mask != 0) {
+            for (int lane = 0; lane < 4; ++lane) {
+                if (mask & (1 << lane)) {
+                    auto collect_result = TryCollectPoint(a, b, {xs[i + lane], ys[i + lane]});
+                    if (collect_result.IsCollected(gatherer_width + widths[i + lane])) {
+                        hits[hits_count++] = {i + lane, collect_result};
+                    }
+                }
+            }
+        }
+    }
+
+    //
+    //  хвост пакета проверяю по одному
+    //
+    const size_t tail = TryCollectPointsAxisAlignedScalar(a, b, gatherer_width, xs + i, ys + i, widths + i, count - i, hits + hits_count);
+    for (size_t h = hits_count; h < hits_count + tail; ++h) {
+        hits[h].index += i;
+    }
+
+    return hits_count + tail;
+}
+
+#endif // GEOM_X86_SIMD
+
+using TryCollectPointsFn = size_t (*)(Point2D, Point2D, double,
+                                      const double*, const double*, const double*, size_t,
+                                      CollectionHit*);
+
+//
+//  Выбираю лучшую реализацию для процессора, на котором запущен сервер
+//
+TryCollectPointsFn SelectTryCollectPoints() noexcept {
+#ifdef GEOM_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return TryCollectPointsAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return TryCollectPointsSse2;
+    }
+#endif
+    return TryCollectPointsScalar;
+}
+
+TryCollectPointsFn SelectTryCollectPointsAxisAligned() noexcept {
+#ifdef GEOM_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return TryCollectPointsAxisAlignedAvx2;
+    }
+#endif
+    return TryCollectPointsAxisAlignedScalar;
+}
+
+} // namespace
+
+void ItemGrid::Build(std::span<const Item> items) {
+
+    ids_.resize(items.size());
+    xs_.resize(items.size());
+    ys_.resize(items.size());
+    widths_.resize(items.size());
+    indices_.resize(items.size());
+
+    if (items.empty()) {
+        cols_ = rows_ = 0;
+        cell_start_.assign(1, 0);
+        return;
+    }
+
+    double max_x = items.front().position.x;
+    double max_y = items.front().position.y;
+    min_x_ = max_x;
+    min_y_ = max_y;
+    max_item_width_ = 0;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto& item = items[i];
+
+        min_x_ = std::min(min_x_, item.position.x);
+        min_y_ = std::min(min_y_, item.position.y);
+        max_x = std::max(max_x, item.position.x);
+        max_y = std::max(max_y, item.position.y);
+        max_item_width_ = std::max(max_item_width_, item.width);
+        ids_[i] = item.id;
+    }
+
+    //
+    //  На маленьком числе предметов сетка себя не окупает - тогда
+    //  вся сетка состоит из одной ячейки
+    //
+    if (items.size() < GRID_MIN_ITEMS) {
+        cols_ = rows_ = 1;
+    }
+    else {
+        InitCells(max_x, max_y, items.size());
+    }
+
+    //
+    //  Сортировка подсчетом: сначала размер каждой ячейки,
+    //  затем раскладываю предметы
+    //
+    cell_start_.assign(cols_ * rows_ + 1, 0);
+    for (const auto& item : items) {
+        ++cell_start_[CellOf(item.position) + 1];
+    }
+    for (size_t c = 1; c < cell_start_.size(); ++c) {
+        cell_start_[c] += cell_start_[c - 1];
+    }
+
+    fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+    for (size_t i = 0; i < items.size(); ++i) {
+        const size_t pos = fill_[CellOf(items[i].position)]++;
+        xs_[pos] = items[i].position.x;
+        ys_[pos] = items[i].position.y;
+        widths_[pos] = items[i].width;
+        indices_[pos] = i;
+    }
+}
+
+void ItemGrid::Collect(const Gatherer& gatherer, std::vector<CollectionHit>& hits) const {
+
+    hits.clear();
+
+    if (indices_.empty()) {
+        return;
+    }
+
+    if (cols_ == 1 && rows_ == 1) {
+        CollectSpan(gatherer, 0, indices_.size(), hits);
+        return;
+    }
+
+    const double reach = gatherer.width + max_item_width_ + QUERY_SLACK;
+
+    const double left = std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach;
+    const double right = std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach;
+    const double top = std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach;
+    const double bottom = std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach;
+
+    const double col_first = std::floor((left - min_x_) / cell_size_);
+    const double col_last = std::floor((right - min_x_) / cell_size_);
+    const double row_first = std::floor((top - min_y_) / cell_size_);
+    const double row_last = std::floor((bottom - min_y_) / cell_size_);
+
+    //
+    //  сборщик целиком за пределами сетки
+    //
+    if (col_last < 0 || row_last < 0 
+        || col_first >= static_cast<double>(cols_) || row_first >= static_cast<double>(rows_)) {
+        return;
+    }
+
+    const size_t c0 = static_cast<size_t>(std::max(col_first, 0.0));
+    const size_t c1 = std::min(static_cast<size_t>(col_last), cols_ - 1);
+    const size_t r0 = static_cast<size_t>(std::max(row_first, 0.0));
+    const size_t r1 = std::min(static_cast<size_t>(row_last), rows_ - 1);
+
+    //
+    //  Ячейки одной строки идут подряд - их предметы проверяю одним пакетом
+    //
+    for (size_t r = r0; r <= r1; ++r) {
+        CollectSpan(gatherer, cell_start_[r * cols_ + c0], cell_start_[r * cols_ + c1 + 1], hits);
+    }
+
+    //
+    //  Предметы проверяются в порядке ячеек, а события нужны в том же порядке,
+    //  что и при полном переборе - тогда и итоговый порядок (после сортировки) совпадет
+    //
+    std::sort(hits.begin(), hits.end(), [](const CollectionHit& l, const CollectionHit& r) {
+        return l.index < r.index;
+    });
+}
+
+//
+//  проверить пакетом предметы [first, last) и дописать попадания в hits
+//
+void ItemGrid::CollectSpan(const Gatherer& gatherer, size_t first, size_t last, std::vector<CollectionHit>& hits) const {
+
+    const size_t found = hits.size();
+    hits.resize(found + (last - first));
+
+    const size_t count = TryCollectPoints(gatherer.start_pos, gatherer.end_pos, gatherer.width,
+                                          xs_.data() + first, ys_.data() + first, widths_.data() + first,
+                                          last - first, hits.data() + found);
+    hits.resize(found + count);
+
+    for (size_t h = found; h < hits.size(); ++h) {
+        hits[h].index = indices_[first + hits[h].index];
+    }
+}
+
+void ItemGrid::InitCells(double max_x, double max_y, size_t items_count) {
+
+    //
+    //  Размер ячейки не меньше MIN_CELL_SIZE, но и ячеек не должно быть
+    //  больше, чем MAX_CELLS_PER_ITEM на каждый предмет - иначе на разреженной
+    //  большой карте сетка съест всю память
+    //
+    cell_size_ = MIN_CELL_SIZE;
+    const double max_cells = static_cast<double>(items_count * MAX_CELLS_PER_ITEM);
+    while (CellsAlong(max_x - min_x_) * CellsAlong(max_y - min_y_) > max_cells) {
+        cell_size_ *= 2;
+    }
+
+    cols_ = static_cast<size_t>(CellsAlong(max_x - min_x_));
+    rows_ = static_cast<size_t>(CellsAlong(max_y - min_y_));
+}
+
+double ItemGrid::CellsAlong(double extent) const noexcept {
+    return std::floor(extent / cell_size_) + 1;
+}
+
+size_t ItemGrid::CellOf(const Point2D& pt) const noexcept {
+    const auto col = std::min(static_cast<size_t>((pt.x - min_x_) / cell_size_), cols_ - 1);
+    const auto row = std::min(static_cast<size_t>((pt.y - min_y_) / cell_size_), rows_ - 1);
+    return row * cols_ + col;
+}
+
+size_t TryCollectPoints(Point2D a, Point2D b, double gatherer_width,
+                        const double* xs, const double* ys, const double* widths, size_t count,
+                        CollectionHit* hits) {
+
+    static const TryCollectPointsFn try_collect = SelectTryCollectPoints();
+    static const TryCollectPointsFn try_collect_axis_aligned = SelectTryCollectPointsAxisAligned();
+
+    if (a.x == b.x || a.y == b.y) {
+        return try_collect_axis_aligned(a, b, gatherer_width, xs, ys, widths, count, hits);
+    }
+
+    return try_collect(a, b, gatherer_width, xs, ys, widths, count, hits);
+}
+
+std::vector<GatheringEvent> FindGatherEventsBruteForce(std::span<const Item> items, std::span<const Gatherer> gatherers) {
+
     std::vector<GatheringEvent> detected_events;
 
-    static auto eq_pt = [](geom::Point2D p1, geom::Point2D p2) {
+    for (const auto& gatherer : gatherers) {
+
         //
-        //   учитывайте перемещение на любое ненулевое расстояние — погрешностью можно пренебречь
+        //  Если объект не переместился, считайте, что он не совершил столкновений.
         //
-        return p1.x == p2.x && p1.y == p2.y;
-    };
+        if (IsSamePoint(gatherer.start_pos, gatherer.end_pos)) {
+            continue;
+        }
 
-    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
-        
-        Gatherer gatherer = provider.GetGatherer(g);
+        for (const auto& item : items) {
+            TryGatherItem(gatherer, item, detected_events);
+        }
+    }
+
+    SortByTime(detected_events);
+
+    return detected_events;
+}
+
+void GatherEventsFinder::SetItems(std::span<const Item> items) {
+
+    grid_.Build(items);
+
+    //
+    //  один сборщик не может задеть больше предметов, чем их есть в сетке
+    //
+    hits_.reserve(items.size());
+}
+
+const std::vector<GatheringEvent>& GatherEventsFinder::Find(std::span<const Gatherer> gatherers) {
+
+    events_.clear();
+
+    if (grid_.Empty()) {
+        return events_;
+    }
+
+    //
+    //  обычно сборщик за тик задевает не больше одного предмета -
+    //  буфер событий растет только в редкие "урожайные" тики
+    //
+    events_.reserve(gatherers.size() + grid_.Size());
+
+    for (const auto& gatherer : gatherers) {
 
         //
         //  Если объект не переместился, считайте, что он не совершил столкновений.
         //
-        if (eq_pt(gatherer.start_pos, gatherer.end_pos)) {
+        if (IsSamePoint(gatherer.start_pos, gatherer.end_pos)) {
             continue;
         }
 
+        grid_.Collect(gatherer, hits_);
 
-        for (size_t i = 0; i < provider.ItemsCount(); ++i) {
-            Item item = provider.GetItem(i);
-            auto collect_result
-                = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
-
-            if (collect_result.IsCollected(gatherer.width + item.width)) {
-                GatheringEvent evt{.item_id = item.id, // i,
-                                   .gatherer_id = gatherer.id, // g,
-                                   .sq_distance = collect_result.sq_distance,
-                                   .time = collect_result.proj_ratio};
-                detected_events.push_back(evt);
-            }
+        for (const auto& hit : hits_) {
+            events_.push_back(GatheringEvent{.item_id = grid_.GetItemId(hit.index),
+                                             .gatherer_id = gatherer.id,
+                                             .sq_distance = hit.result.sq_distance,
+                                             .time = hit.result.proj_ratio});
         }
     }
 
-    //
-    //  Функция возвращает вектор событий, идущих в хронологическом порядке.
-    //  Порядок одновременно произошедших событий может быть любым.
-    //
-    std::sort(detected_events.begin(), detected_events.end(),
-              [](const GatheringEvent& e_l, const GatheringEvent& e_r) {
-                  return e_l.time < e_r.time;
-              });
+    SortByTime(events_);
 
-    return detected_events;
+    return events_;
+}
+
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers) {
+
+    GatherEventsFinder finder;
+    finder.SetItems(items);
+
+    return finder.Find(gatherers);
 }
 
+namespace {
+
+//
+//  Переходник от виртуального интерфейса к массивам
+//
+std::pair<std::vector<Item>, std::vector<Gatherer>> CollectProvider(const ItemGathererProvider& provider) {
+
+    std::vector<Item> items;
+    items.reserve(provider.ItemsCount());
+    for (size_t i = 0; i < provider.ItemsCount(); ++i) {
+        items.push_back(provider.GetItem(i));
+    }
+
+    std::vector<Gatherer> gatherers;
+    gatherers.reserve(provider.GatherersCount());
+    for (size_t g = 0; g < provider.GatherersCount(); ++g) {
+        gatherers.push_back(provider.GetGatherer(g));
+    }
+
+    return {std::move(items), std::move(gatherers)};
+}
+
+} // namespace
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+
+    const auto [items, gatherers] = CollectProvider(provider);
+
+    return FindGatherEvents(items, gatherers);
+}
+
+std::vector<GatheringEvent> FindGatherEventsBruteForce(const ItemGathererProvider& provider) {
+
+    const auto [items, gatherers] = CollectProvider(provider);
+
+    return FindGatherEventsBruteForce(items, gatherers);
+}
 
 }  // namespace geom
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <span>
 #include <vector>
 
 namespace geom {
@@ -39,6 +40,33 @@ struct CollectionResult {
 // Движемся из точки a в точку b и пытаемся подобрать точку c
 CollectionResult TryCollectPoint(Point2D a, Point2D b, Point2D c);
 
+//
+//  Результат пакетной проверки - номер подобранного предмета в пакете
+//  и параметры столкновения
+//
+struct CollectionHit {
+    size_t index;
+    CollectionResult result;
+};
+
+//
+//  Пакетная версия TryCollectPoint: сборщик радиусом gatherer_width движется
+//  из точки a в точку b, предметы заданы массивами координат и радиусов.
+//  Предметы проверяются по 4 (AVX2) или по 2 (SSE2) за раз, если процессор
+//  это умеет. В hits (места должно хватать на count элементов) записываются
+//  только подобранные предметы в порядке возрастания номера, функция возвращает
+//  их количество. Для произвольного отрезка результат в точности совпадает с поштучной проверкой
+//  TryCollectPoint + CollectionResult::IsCollected.
+//
+//  Для отрезков вдоль оси X или Y (так ходят собаки) предметы сначала
+//  отсеиваются без деления - попаданием в интервал по оси движения и
+//  расстоянием до линии движения (с небольшим запасом), а прошедшие отсев
+//  проверяются общей формулой, так что результат тот же.
+//
+size_t TryCollectPoints(Point2D a, Point2D b, double gatherer_width,
+                        const double* xs, const double* ys, const double* widths, size_t count,
+                        CollectionHit* hits);
+
 struct Item {
     Point2D position;
     double width;
@@ -68,6 +96,100 @@ struct GatheringEvent {
     double time;
 };
 
+//
+//  Предметы, разложенные по ячейкам равномерной сетки. Координаты и радиусы
+//  лежат в отдельных массивах в порядке ячеек (структура массивов), чтобы
+//  предметы одной строки ячеек можно было проверять пакетом. Для каждой
+//  ячейки известно смещение ее начала, а для каждого предмета - его номер
+//  в исходном списке. Build переиспользует память прошлой сборки.
+//
+class ItemGrid {
+public:
+    void Build(std::span<const Item> items);
+
+    bool Empty() const noexcept {
+        return indices_.empty();
+    }
+
+    size_t Size() const noexcept {
+        return indices_.size();
+    }
+
+    size_t GetItemId(size_t idx) const noexcept {
+        return ids_[idx];
+    }
+
+    //
+    //  Проверить сборщика с предметами из ячеек, которые он может задеть, и
+    //  записать в hits подобранные предметы (с номерами из исходного списка,
+    //  по возрастанию). Отрезок перемещения расширяется на радиус сборщика
+    //  и на максимальный радиус предмета, плюс небольшой запас на погрешность
+    //
+    void Collect(const Gatherer& gatherer, std::vector<CollectionHit>& hits) const;
+
+private:
+    static constexpr double MIN_CELL_SIZE = 2.0;
+    static constexpr size_t MAX_CELLS_PER_ITEM = 4;
+    static constexpr double QUERY_SLACK = 1e-6;
+
+    void CollectSpan(const Gatherer& gatherer, size_t first, size_t last, std::vector<CollectionHit>& hits) const;
+    void InitCells(double max_x, double max_y, size_t items_count);
+    double CellsAlong(double extent) const noexcept;
+    size_t CellOf(const Point2D& pt) const noexcept;
+
+    double min_x_ = 0;
+    double min_y_ = 0;
+    double cell_size_ = MIN_CELL_SIZE;
+    double max_item_width_ = 0;
+    size_t cols_ = 0;
+    size_t rows_ = 0;
+    std::vector<size_t> cell_start_;
+    std::vector<size_t> fill_;
+    std::vector<size_t> ids_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> widths_;
+    std::vector<size_t> indices_;
+};
+
+//
+//  Поиск событий, который можно повторять из тика в тик без выделения
+//  памяти: сетка предметов пересобирается только по SetItems, а буферы
+//  попаданий и событий сохраняют емкость между вызовами
+//
+class GatherEventsFinder {
+public:
+    void SetItems(std::span<const Item> items);
+
+    //
+    //  события в хронологическом порядке; ссылка действительна
+    //  до следующего вызова Find
+    //
+    const std::vector<GatheringEvent>& Find(std::span<const Gatherer> gatherers);
+
+private:
+    ItemGrid grid_;
+    std::vector<CollectionHit> hits_;
+    std::vector<GatheringEvent> events_;
+};
+
+//
+//  Поиск событий с широкой фазой на равномерной сетке: предметы раскладываются
+//  по ячейкам, а каждый сборщик проверяется только с предметами из ячеек,
+//  которые задевает его отрезок перемещения (расширенный на радиусы).
+//  Результат в точности совпадает с FindGatherEventsBruteForce.
+//
+//  Предметы и сборщики передаются непрерывными массивами, без виртуальных
+//  вызовов на каждый элемент; версия с ItemGathererProvider - переходник,
+//  который копирует элементы провайдера в массивы
+//
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers);
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
+//
+//  Поиск событий полным перебором всех пар "сборщик - предмет"
+//
+std::vector<GatheringEvent> FindGatherEventsBruteForce(std::span<const Item> items, std::span<const Gatherer> gatherers);
+std::vector<GatheringEvent> FindGatherEventsBruteForce(const ItemGathererProvider& provider);
+
 }  // namespace geom
\ No newline at end of file
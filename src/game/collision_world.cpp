@@ -0,0 +1,51 @@
+#include "../sdk.h"
+#include <cassert>
+
+#include "collision_world.h"
+
+namespace model {
+
+void CollisionWorld::AddStatic(const geom::Item& item) {
+
+    assert(items_.size() == static_count_ && "static items go before loot");
+
+    items_.push_back(item);
+    ++static_count_;
+    dirty_ = true;
+}
+
+void CollisionWorld::AddLoot(const geom::Item& item) {
+    items_.push_back(item);
+    dirty_ = true;
+}
+
+void CollisionWorld::EraseLoot(size_t slot) {
+
+    const size_t idx = static_count_ + slot;
+
+    //
+    //  как и в LootStorage, на место удаляемого трофея переношу последний
+    //
+    if (idx + 1 != items_.size()) {
+        items_[idx] = items_.back();
+    }
+    items_.pop_back();
+    dirty_ = true;
+}
+
+void CollisionWorld::ClearLoots() noexcept {
+    items_.resize(static_count_);
+    dirty_ = true;
+}
+
+const std::vector<geom::GatheringEvent>& CollisionWorld::FindEvents() {
+
+    if (dirty_) {
+        finder_.SetItems(items_);
+        dirty_ = false;
+    }
+
+    return finder_.Find(gatherers_);
+}
+
+} // namespace model
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+
+#include "collision_detector.h"
+
+namespace model {
+
+//
+//  Мир столкновений игровой сессии: предметы, которые могут подобрать собаки,
+//  живут здесь между тиками. Офисы добавляются один раз при создании сессии,
+//  трофеи - по мере появления и исчезновения. Порядок трофеев повторяет
+//  слоты LootStorage (с тем же swap-remove при удалении), поэтому трофей
+//  удаляется за O(1) по номеру слота. Сетка предметов пересобирается только
+//  после изменений, а буферы сборщиков и событий переиспользуются - в
+//  установившемся режиме тик не выделяет память.
+//
+class CollisionWorld {
+public:
+    //
+    //  статические предметы (офисы) - только до первого трофея
+    //
+    void AddStatic(const geom::Item& item);
+
+    void AddLoot(const geom::Item& item);
+    void EraseLoot(size_t slot);
+    void ClearLoots() noexcept;
+
+    size_t ItemsCount() const noexcept {
+        return items_.size();
+    }
+
+    //
+    //  буфер, куда перемещение собак записывает сборщиков текущего тика
+    //
+    std::vector<geom::Gatherer>& Gatherers() noexcept {
+        return gatherers_;
+    }
+
+    //
+    //  события текущего тика в хронологическом порядке
+    //
+    const std::vector<geom::GatheringEvent>& FindEvents();
+
+private:
+    std::vector<geom::Item> items_;
+    size_t static_count_ = 0;
+    bool dirty_ = true;
+
+    std::vector<geom::Gatherer> gatherers_;
+    geom::GatherEventsFinder finder_;
+};
+
+} // namespace model
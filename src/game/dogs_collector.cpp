@@ -11,7 +11,7 @@ DogsCollector::DogsCollector(model::Game::Ptr game, app::Players::Ptr players, p
 
 }
 
-void DogsCollector::CollectRetiredDogs() noexcept {
+void DogsCollector::CollectRetiredDogs(const model::GameSession& session) noexcept {
     try {
         //
         //  получаю массив токенов и пользователей, для каждого
@@ -19,11 +19,12 @@ void DogsCollector::CollectRetiredDogs() noexcept {
         //  стало больше или равно "dogRetirementTime" - игрок удаляется
         //
 
-        auto tokens = players_->GetPairs();
+        auto tokens = players_->GetPairs(session);
 
         for (const auto &token : tokens) {
             if (token.second->GetIdleTime() >= game_->GetRetirementTime()) {
                 auto statistics = players_->RemovePlayer(token.first);
+                game_->FreeSeat(session);
                 db_.SaveRecord(statistics);
             }
         }
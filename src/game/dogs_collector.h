@@ -19,7 +19,11 @@ class DogsCollector
 public:
     DogsCollector(model::Game::Ptr game, app::Players::Ptr players, postgres::Database& db);
 
-    void CollectRetiredDogs() noexcept;
+    //
+    //  удалить ушедших на покой игроков одной сессии,
+    //  вызывается в strand этой сессии
+    //
+    void CollectRetiredDogs(const model::GameSession& session) noexcept;
 
 private:
     model::Game::Ptr    game_;
@@ -0,0 +1,124 @@
+#pragma once
+#include <cmath>
+#include <compare>
+#include <cstdint>
+
+#include "geom.h"
+
+namespace geom {
+
+//
+//  Координаты с фиксированной точкой: 32-битное целое в 1/1024 единицы карты.
+//  Сложение и сравнение таких координат точные, поэтому перемещение собак
+//  воспроизводится бит в бит на любом потоке и любой платформе, а точка
+//  занимает 8 байт вместо 16. В этом виде координаты и скорости собак и трофеев
+//  хранятся, если сервер собран с опцией GAME_FIXED_POINT_COORDS; наружу
+//  (в API, JSON, сохранение) они все равно выдаются как Point2D/Vec2D.
+//
+struct FixedPoint2D {
+    std::int32_t x = 0;
+    std::int32_t y = 0;
+
+    auto operator<=>(const FixedPoint2D&) const = default;
+};
+
+//
+//  скорость - в 1/1024 единицы карты за секунду
+//
+struct FixedVec2D {
+    std::int32_t x = 0;
+    std::int32_t y = 0;
+
+    auto operator<=>(const FixedVec2D&) const = default;
+};
+
+namespace fixed {
+
+inline constexpr std::int32_t ONE = 1024;
+
+inline std::int32_t FromReal(double value) noexcept {
+    return static_cast<std::int32_t>(std::llround(value * ONE));
+}
+
+//
+//  округление в сторону to - так точка на краю дороги не выходит за край
+//
+inline std::int32_t FromRealToward(double value, std::int32_t to) noexcept {
+    const double scaled = value * ONE;
+    return static_cast<std::int32_t>(scaled > to ? std::floor(scaled) : std::ceil(scaled));
+}
+
+//
+//  1/1024 - степень двойки, поэтому перевод в double точный
+//
+inline double ToReal(std::int32_t raw) noexcept {
+    return static_cast<double>(raw) / ONE;
+}
+
+} // namespace fixed
+
+inline FixedPoint2D ToFixed(const Point2D& pt) noexcept {
+    return {fixed::FromReal(pt.x), fixed::FromReal(pt.y)};
+}
+
+inline FixedPoint2D ToFixedToward(const Point2D& pt, const FixedPoint2D& to) noexcept {
+    return {fixed::FromRealToward(pt.x, to.x), fixed::FromRealToward(pt.y, to.y)};
+}
+
+inline FixedVec2D ToFixed(const Vec2D& vec) noexcept {
+    return {fixed::FromReal(vec.x), fixed::FromReal(vec.y)};
+}
+
+inline Point2D ToReal(const FixedPoint2D& pt) noexcept {
+    return {fixed::ToReal(pt.x), fixed::ToReal(pt.y)};
+}
+
+inline Vec2D ToReal(const FixedVec2D& vec) noexcept {
+    return {fixed::ToReal(vec.x), fixed::ToReal(vec.y)};
+}
+
+//
+//  Формат, в котором хранятся координаты и скорости объектов сессии,
+//  и перевод в него и обратно (без фиксированной точки - без изменений)
+//
+#ifdef GAME_FIXED_POINT_COORDS
+using StoredPoint2D = FixedPoint2D;
+using StoredVec2D = FixedVec2D;
+#else
+using StoredPoint2D = Point2D;
+using StoredVec2D = Vec2D;
+#endif
+
+inline StoredPoint2D StorePoint(const Point2D& pt) noexcept {
+#ifdef GAME_FIXED_POINT_COORDS
+    return ToFixed(pt);
+#else
+    return pt;
+#endif
+}
+
+inline StoredVec2D StoreVec(const Vec2D& vec) noexcept {
+#ifdef GAME_FIXED_POINT_COORDS
+    return ToFixed(vec);
+#else
+    return vec;
+#endif
+}
+
+inline Point2D LoadPoint(const StoredPoint2D& pt) noexcept {
+#ifdef GAME_FIXED_POINT_COORDS
+    return ToReal(pt);
+#else
+    return pt;
+#endif
+}
+
+inline Vec2D LoadVec(const StoredVec2D& vec) noexcept {
+#ifdef GAME_FIXED_POINT_COORDS
+    return ToReal(vec);
+#else
+    return vec;
+#endif
+}
+
+} // namespace geom
@@ -4,6 +4,8 @@
 #include "game_session.h"
 #include <iostream>
 #include <numeric>
+#include <algorithm>
+#include <random>
 
 namespace model {
 
@@ -39,10 +41,12 @@ Dog::Dog(Id id, const std::string &name,
 //  пробую подобрать трофей - но он может не влезть в мешок
 //  если трофей подобрался - true, нет - false
 // 
-bool Dog::TryGatherLoot(const Loot& loot)
+bool DogRef::TryGatherLoot(const Loot::Traits& loot)
 {
-    if (bag_.size() < bag_capacity_) {
-        bag_.emplace_back(loot.GetId(), loot.GetType(), loot.GetValue());
+    auto& bag = Storage().bags_[slot_];
+
+    if (bag.size() < GetBagCapacity()) {
+        bag.push_back(loot);
         return true;
     }
 
@@ -53,7 +57,7 @@ bool Dog::TryGatherLoot(const Loot& loot)
 //  сгружаю трофеи на базу, за каждый трофей увеличиваю счет
 //  на стоимость трофея
 //
-void Dog::UnloadBag() {
+void DogRef::UnloadBag() {
     //
     //  Добавить в копилку стоимость каждого трофея - и затем
     //  очистить мешок
@@ -64,15 +68,31 @@ void Dog::UnloadBag() {
     //     }
     // );
 
-    for (const auto &item : bag_) {
-        score_ += item.value;
+    auto& bag = Storage().bags_[slot_];
+    auto& score = Storage().scores_[slot_];
+
+    for (const auto &item : bag) {
+        score += item.value;
     }
 
-    bag_.clear();
+    bag.clear();
 }
 
-void Dog::ChangeDir(Direction dir) noexcept
+void DogRef::ChangeDir(Dog::Direction dir) noexcept
 {
+    auto& storage = Storage();
+    auto& direction = storage.directions_[slot_];
+    auto& idle_time = storage.idle_times_[slot_];
+    auto& speed = storage.speeds_[slot_];
+    const auto max_speed = GetMaxSpeed();
+
+    //
+    //  новое движение начинается из текущей точки в текущий момент
+    //
+    storage.positions_[slot_] = geom::StorePoint(GetPos());
+    storage.origin_times_[slot_] = storage.clock_;
+    storage.idle_since_[slot_] = storage.clock_;
+
     //
     //  TODO: корректно обработать случай когда направление не изменилось,
     //  чтобы не делать лишней работы
@@ -81,73 +101,61 @@ void Dog::ChangeDir(Direction dir) noexcept
     //
     //  при остановке персонажа я не меняю направление движения
     //
-    dir_ = (dir != Direction::Stop) ? dir : dir_;
+    direction = (dir != Dog::Direction::Stop) ? dir : direction;
 
     //
     //  если задано какое-то направление движения - нужно сбросить
     //  счетчик простоя; при этом кажется странным что счетчик сбрасывается даже при остановке
     //  собаки - но автотесты заточены именно на такое поведение
     //
-    if (idle_time_.count() != 0) {
-        idle_time_ = 0ms;
-    }
+    idle_time = 0ms;
     
     switch (dir)
     {
-    case Direction::Left:
-        speed_ = {-max_speed_, 0};
+    case Dog::Direction::Left:
+        speed = geom::StoreVec({-max_speed, 0});
         break;
 
-    case Direction::Right:
-        speed_ = {max_speed_, 0};
+    case Dog::Direction::Right:
+        speed = geom::StoreVec({max_speed, 0});
         break;
 
-    case Direction::Up:
-        speed_ = {0, -max_speed_};
+    case Dog::Direction::Up:
+        speed = geom::StoreVec({0, -max_speed});
         break;
 
-    case Direction::Down:
-        speed_ = {0, max_speed_};
+    case Dog::Direction::Down:
+        speed = geom::StoreVec({0, max_speed});
         break;
 
     default:
-        speed_ = {0, 0};
+        speed = geom::StoreVec({0, 0});
+    }
+
+    if (util::IsZero(geom::LoadVec(speed))) {
+        storage.StopMoving(slot_);
+    }
+    else {
+        storage.StartMoving(slot_);
     }
 }
 
 //
-//  найти дорогу, на которой находится собака
+//  найти дорогу (коридор графа дорог), на которой находится собака
 //  если собака движется горизонтально - предпочтение отдается
 //  горизонтальной дороге, если вертикально - вертикальной
 //
-geom::Rect2D FindDogRoad(const Map::Roads& roads, const geom::Point2D& dog_pos, const geom::Vec2D& dog_speed)
+//  road - коридор, найденный в прошлый раз, обновляется
+//
+geom::Rect2D FindDogRoad(const RoadGraph& roads, const geom::Point2D& dog_pos, const geom::Vec2D& dog_speed, RoadGraph::Index& road)
 {
-    geom::Rect2D altRect = { 0, 0, 0, 0 };
-
-    for (const auto& road : roads) {
+    road = roads.Locate(road, dog_pos, util::IsHorizontal(dog_speed));
 
-        geom::Rect2D rect = util::MakeRect2D(road);
-        if (!rect.Test(dog_pos)) {
-            continue;
-        }
-        if (util::IsHorizontal(dog_speed) == util::IsHorizontal(rect)) {
-            return rect;
-        }
-
-        altRect = rect;
+    if (road == RoadGraph::NO_CORRIDOR) {
+        return { 0, 0, 0, 0 };
     }
 
-    return altRect;
-}
-
-geom::Point2D MoveDog(const geom::Point2D& dog_pos, const geom::Vec2D& dog_speed, TimeInterval dt)
-{
-    geom::Point2D newPos = {};
-
-    newPos.x = (util::IsZero(dog_speed.x)) ? dog_pos.x : (dog_pos.x + dog_speed.x * util::TimeDeltaToSeconds(dt));
-    newPos.y = (util::IsZero(dog_speed.y)) ? dog_pos.y : (dog_pos.y + dog_speed.y * util::TimeDeltaToSeconds(dt));
-
-    return newPos;
+    return roads.GetRect(road);
 }
 
 geom::Point2D FindBoundary(const geom::Rect2D& rect, const geom::Point2D& dog_pos, Dog::Direction dir) {
@@ -184,57 +192,239 @@ geom::Point2D FindBoundary(const geom::Rect2D& rect, const geom::Point2D& dog_po
 }
 
 //
-//  результат каждого перемещения - начальная и конечная точки собаки
-//  их потом легко поместить в алгоритм поиска коллизий
+//  Точка, в которую собака пришла из origin со скоростью speed за время dt
+//
+geom::Point2D AdvanceFrom(const geom::Point2D& origin, const geom::Vec2D& speed, TimeInterval dt) noexcept {
+
+    const double seconds = util::TimeDeltaToSeconds(dt);
+
+    return {
+        util::IsZero(speed.x) ? origin.x : origin.x + speed.x * seconds,
+        util::IsZero(speed.y) ? origin.y : origin.y + speed.y * seconds
+    };
+}
+
+//
+//  то же в фиксированной точке - только целочисленная арифметика
+//
+geom::FixedPoint2D AdvanceFrom(const geom::FixedPoint2D& origin, const geom::FixedVec2D& speed, TimeInterval dt) noexcept {
+
+    const std::int64_t ms = dt.count();
+
+    return {
+        static_cast<std::int32_t>(origin.x + speed.x * ms / 1000),
+        static_cast<std::int32_t>(origin.y + speed.y * ms / 1000)
+    };
+}
+
+//
+//  Запомнить точку на краю дороги. В фиксированной точке координата
+//  округляется в сторону from (внутрь дороги), а не к ближайшему
+//
+geom::Point2D StoreBoundary(const geom::Point2D& boundary, const geom::Point2D& /*from*/) noexcept {
+    return boundary;
+}
+
+geom::FixedPoint2D StoreBoundary(const geom::Point2D& boundary, const geom::FixedPoint2D& from) noexcept {
+    return geom::ToFixedToward(boundary, from);
+}
+
+//
+//  Тик: часы хранилища сдвигаются на dt, и каждая движущаяся собака
+//  продвигается по своему коридору. Собака, которая за тик ушла бы
+//  за пределы дороги, останавливается на ее краю и выбывает из списка
+//  движущихся. Стоящих собак тик не трогает вовсе
 //
-geom::Gatherer Dog::Move(const class Map& map, TimeInterval dt)
+void DogStorage::Move(const RoadGraph& roads, TimeInterval dt, std::vector<geom::Gatherer>& gatherers)
 {
-    //
-    //  В любом случае с каждым движением увеличивается время в игре
-    //
-    play_time_ += dt;
+    const auto prev = std::exchange(clock_, clock_ + dt);
 
-    //
-    //  Если скорость собаки равна нулю - то она никуда не движется,
-    //  но увеличивается время простоя
-    //
-    if (util::IsZero(speed_)) {
-        idle_time_ += dt;
-        return {pos_, pos_, WIDTH, id_};
+    gatherers.clear();
+    gatherers.reserve(moving_.size());
+
+    for (size_t idx = 0; idx < moving_.size();) {
+
+        const size_t slot = moving_[idx];
+        const auto oldPos = GetPosAt(slot, prev);
+
+        //
+        //  Найти дорогу, по которой движется собака
+        //  Если дороги нашлось две (перекресток), выбрать
+        //  ту дорогу, направление которой совпадает с направлением
+        //  движения собаки. Соседние дороги на одной прямой слиты
+        //  в один коридор, поэтому собака проходит их стык не останавливаясь
+        //
+        const auto rect = FindDogRoad(roads, oldPos, geom::LoadVec(speeds_[slot]), roads_[slot]);
+
+        //
+        //  Может ли собака продвинуться по дороге на дельту
+        //  и не уйти за пределы?
+        //
+        const auto newPos = GetPosAt(slot, clock_);
+        if (rect.Test(newPos)) {
+            gatherers.push_back({oldPos, newPos, Dog::WIDTH, ids_[slot]});
+            ++idx;
+            continue;
+        }
+
+        //
+        //  При полном движении собака уходит за пределы дороги
+        //  Нужно дойти до края дороги и остановиться на нем;
+        //  простой начинается с конца этого тика
+        //
+        positions_[slot] = StoreBoundary(FindBoundary(rect, oldPos, directions_[slot]), positions_[slot]);
+        origin_times_[slot] = clock_;
+        idle_since_[slot] = clock_;
+        speeds_[slot] = geom::StoreVec({0, 0});
+
+        gatherers.push_back({oldPos, geom::LoadPoint(positions_[slot]), Dog::WIDTH, ids_[slot]});
+
+        //
+        //  на место idx встает последняя движущаяся собака
+        //
+        StopMoving(slot);
     }
+}
 
-    //
-    //  Получить список дорог
-    //
-    const auto &roads = map.GetRoads();
+geom::Point2D DogStorage::GetPosAt(size_t slot, TimeInterval t) const noexcept
+{
+    if (!IsMoving(slot)) {
+        return geom::LoadPoint(positions_[slot]);
+    }
 
     //
-    //  Найти дорогу, по которой движется собака
-    //  Если дороги нашлось две (перекресток), выбрать
-    //  ту дорогу, направление которой совпадает с направлением
-    //  движения собаки
+    //  координата считается от точки начала движения, а не накапливается
+    //  по тикам, поэтому ошибки округления не копятся
     //
-    const auto rect = FindDogRoad(roads, pos_, speed_);
-    
+    return geom::LoadPoint(AdvanceFrom(positions_[slot], speeds_[slot], t - origin_times_[slot]));
+}
+
+TimeInterval DogStorage::GetIdleTime(size_t slot) const noexcept
+{
+    if (IsMoving(slot)) {
+        return idle_times_[slot];
+    }
+
+    return idle_times_[slot] + (clock_ - idle_since_[slot]);
+}
+
+//
+//  moving_ зарезервирован под всех собак хранилища (см. emplace_back),
+//  поэтому добавление в него не выделяет память
+//
+void DogStorage::StartMoving(size_t slot) noexcept
+{
+    if (!IsMoving(slot)) {
+        moving_index_[slot] = moving_.size();
+        moving_.push_back(slot);
+    }
+}
+
+void DogStorage::StopMoving(size_t slot) noexcept
+{
+    if (!IsMoving(slot)) {
+        return;
+    }
+
+    const size_t idx = moving_index_[slot];
+    const size_t last = moving_.back();
+
+    moving_[idx] = last;
+    moving_index_[last] = idx;
+    moving_.pop_back();
+    moving_index_[slot] = NOT_MOVING;
+}
+
+DogView DogStorage::operator[](size_t slot) const noexcept {
+    return {*this, slot};
+}
+
+DogRef DogStorage::operator[](size_t slot) noexcept {
+    return {*this, slot};
+}
+
+DogStorage::const_iterator DogStorage::begin() const noexcept {
+    return {*this, 0};
+}
+
+DogStorage::const_iterator DogStorage::end() const noexcept {
+    return {*this, size()};
+}
+
+DogStorage::iterator DogStorage::begin() noexcept {
+    return {*this, 0};
+}
+
+DogStorage::iterator DogStorage::end() noexcept {
+    return {*this, size()};
+}
+
+DogRef DogStorage::emplace_back(const Dog& dog) {
+
+    const size_t slot = size();
+
+    slots_.Insert(dog.GetId());
+    moving_.reserve(slot + 1);
+    moving_index_.push_back(NOT_MOVING);
+    ids_.push_back(dog.GetId());
+    positions_.push_back(geom::StorePoint(dog.GetPos()));
+    origin_times_.push_back(clock_);
+    speeds_.push_back(geom::StoreVec(dog.GetSpeed()));
+    directions_.push_back(dog.GetDir());
+    idle_times_.push_back(dog.GetIdleTime());
+    idle_since_.push_back(clock_);
+    play_origins_.push_back(clock_ - dog.GetPlayTime());
+    roads_.push_back(RoadGraph::NO_CORRIDOR);
+    names_.push_back(dog.GetName());
+    bags_.push_back(dog.GetBag());
+    scores_.push_back(dog.GetScore());
+    max_speeds_.push_back(dog.GetMaxSpeed());
+    bag_capacities_.push_back(dog.GetBagCapacity());
+
+    if (!util::IsZero(geom::LoadVec(speeds_[slot]))) {
+        StartMoving(slot);
+    }
+
+    return {*this, slot};
+}
+
+void DogStorage::Erase(size_t slot) {
+
+    slots_.Erase(ids_[slot], slot);
+
     //
-    //  Может ли собака продвинуться по дороге на дельту
-    //  и не уйти за пределы?
+    //  удаляемая собака больше не движется, а последняя переезжает в slot
     //
-    auto newPos = MoveDog(pos_, speed_, dt);
-    if (rect.Test(newPos)) {
-        auto oldPos = std::exchange(pos_, newPos);
-        return {oldPos, pos_, WIDTH, id_};
+    StopMoving(slot);
+    if (const size_t last = size() - 1; last != slot && IsMoving(last)) {
+        moving_[moving_index_[last]] = slot;
     }
 
     //
-    //  При полном движении собака уходит за пределы дороги
-    //  Нужно дойти до края дороги и остановиться на нем
+    //  на место удаляемой собаки переношу последнюю
     //
-    auto oldPos = std::exchange(pos_, FindBoundary(rect, pos_, dir_));
-    speed_ = {0, 0};
-
-    return {oldPos, pos_, WIDTH, id_};
-
+    auto erase = [slot](auto& column) {
+        if (slot + 1 != column.size()) {
+            column[slot] = std::move(column.back());
+        }
+        column.pop_back();
+    };
+
+    erase(moving_index_);
+    erase(ids_);
+    erase(positions_);
+    erase(origin_times_);
+    erase(speeds_);
+    erase(directions_);
+    erase(idle_times_);
+    erase(idle_since_);
+    erase(play_origins_);
+    erase(roads_);
+    erase(names_);
+    erase(bags_);
+    erase(scores_);
+    erase(max_speeds_);
+    erase(bag_capacities_);
 }
 
 Loot::Loot(Id id, Type type, Value value, const geom::Point2D& pos)
@@ -243,68 +433,147 @@ Loot::Loot(Id id, Type type, Value value, const geom::Point2D& pos)
 {
 }
 
+LootView LootStorage::operator[](size_t slot) const noexcept {
+    return {*this, slot};
+}
 
-GameSession::GameSession(const Map &map, TimeInterval base_interval, double probability)
-: map_(map)
-, loot_generator_(base_interval, probability) {    
+LootStorage::const_iterator LootStorage::begin() const noexcept {
+    return {*this, 0};
 }
 
+LootStorage::const_iterator LootStorage::end() const noexcept {
+    return {*this, size()};
+}
 
-//
-//  Идентификаторы начинаю с единицы, потому что ноль
-//  зарезервирован под идентификатор(ы) базы
-//
-Dog::Id GameSession::next_dog_id_ = 1;
-Loot::Id GameSession::next_loot_id_ = 1;
+void LootStorage::emplace_back(const Loot& loot) {
+    slots_.Insert(loot.GetId());
+    ids_.push_back(loot.GetId());
+    positions_.push_back(geom::StorePoint(loot.GetPos()));
+    types_.push_back(loot.GetType());
+    values_.push_back(loot.GetValue());
+}
+
+void LootStorage::Erase(size_t slot) {
+
+    slots_.Erase(ids_[slot], slot);
+
+    //
+    //  на место удаляемого трофея переношу последний
+    //
+    auto erase = [slot](auto& column) {
+        if (slot + 1 != column.size()) {
+            column[slot] = std::move(column.back());
+        }
+        column.pop_back();
+    };
 
-Dog* GameSession::AddDog(const std::string& dogName, bool randomize_spawn_point) {
+    erase(ids_);
+    erase(positions_);
+    erase(types_);
+    erase(values_);
+}
+
+
+GameSession::GameSession(const Map &map, TimeInterval base_interval, double probability, Seed random_seed)
+: random_engine_(random_seed)
+, map_(map)
+, loot_generator_(base_interval, probability)
+, epoch_(std::random_device{}()) {
+    assert(map.GetRoadGraph().IsBuilt() && "Map::BuildRoadGraph must be called before sessions are created");
+
+    //
+    //  офисы не двигаются и не исчезают - в мир столкновений
+    //  они попадают один раз
+    //
+    for (const auto& office : map.GetOffices()) {
+        const auto& pos = office.GetPosition();
+        world_.AddStatic({{static_cast<double>(pos.x), static_cast<double>(pos.y)}, Office::WIDTH, 0});
+    }
+
+    //
+    //  читателям сразу есть что читать - пустую сессию
+    //
+    PublishSnapshot();
+}
+
+DogRef GameSession::AddDog(const std::string& dogName, bool randomize_spawn_point) {
 
     geom::Point2D pt = GenerateRandomPoint(randomize_spawn_point);
 
-    auto& dog = dogs_.emplace_back(next_dog_id_++, dogName, pt, map_.GetDogSpeed(), map_.GetBagCapacity());
+    players_changed_ = true;
 
-    return &dog;
+    return dogs_.emplace_back({next_dog_id_++, dogName, pt, map_.GetDogSpeed(), map_.GetBagCapacity()});
 }
 
 void GameSession::AddLoot(Loot::Type type) {
     
     geom::Point2D pt = GenerateRandomPoint(true);
 
-    loots_.emplace_back(next_loot_id_++, type, map_.GetLootTypeValue(type), pt);
+    const Loot::Id id = next_loot_id_++;
+    loots_.emplace_back({id, type, map_.GetLootTypeValue(type), pt});
+
+    //
+    //  координату беру из хранилища - там она может быть округлена
+    //
+    world_.AddLoot({loots_[loots_.size() - 1].GetPos(), Loot::WIDTH, id});
 
 }
 
-Dog* GameSession::FindDog(Dog::Id id) const noexcept {
+std::optional<DogRef> GameSession::FindDog(Dog::Id id) noexcept {
 
-    if (auto it = std::find(dogs_.begin(), dogs_.end(), id); it != dogs_.end()) {
-        return const_cast<Dog*>(&(*it));
+    if (auto slot = dogs_.Find(id)) {
+        return dogs_[*slot];
     }
 
-    return nullptr;
+    return std::nullopt;
+}
+
+std::optional<DogView> GameSession::FindDog(Dog::Id id) const noexcept {
+
+    if (auto slot = dogs_.Find(id)) {
+        return dogs_[*slot];
+    }
+
+    return std::nullopt;
+}
+
+std::optional<DogRef> GameSession::FindDog(SlotHandle handle) noexcept {
+
+    if (auto slot = dogs_.Find(handle)) {
+        return dogs_[*slot];
+    }
+
+    return std::nullopt;
+}
+
+std::optional<SlotHandle> GameSession::FindDogHandle(Dog::Id id) const noexcept {
+    return dogs_.FindHandle(id);
 }
 
 void GameSession::RemoveDog(Dog::Id id) {
 
-    if (auto it = std::find(dogs_.begin(), dogs_.end(), id); it != dogs_.end()) {
-        dogs_.erase(it);
+    if (auto slot = dogs_.Find(id)) {
+        dogs_.Erase(*slot);
+        players_changed_ = true;
     }
 
 }
 
 
-Loot* GameSession::FindLoot(Loot::Id id) const noexcept {
+std::optional<LootView> GameSession::FindLoot(Loot::Id id) const noexcept {
 
-    if (auto it = std::find(loots_.begin(), loots_.end(), id); it != loots_.end()) {
-        return const_cast<Loot*>(&(*it));
+    if (auto slot = loots_.Find(id)) {
+        return loots_[*slot];
     }
 
-    return nullptr;
+    return std::nullopt;
 }
 
 void GameSession::RemoveLoot(Loot::Id id) {
 
-    if (auto it = std::find(loots_.begin(), loots_.end(), id); it != loots_.end()) {
-        loots_.erase(it);
+    if (auto slot = loots_.Find(id)) {
+        world_.EraseLoot(*slot);
+        loots_.Erase(*slot);
     }
 
 }
@@ -312,19 +581,227 @@ void GameSession::RemoveLoot(Loot::Id id) {
 void GameSession::SetDogs(Dogs&& dogs, Dog::Id next_dog_id) {
     dogs_ = std::move(dogs);
     next_dog_id_ = next_dog_id;
+    players_changed_ = true;
+
+    PublishSnapshot();
 }
 
 
 void GameSession::SetLoots(Loots&& loots, Loot::Id next_loot_id) {
     loots_ = std::move(loots);
     next_loot_id_ = next_loot_id;
+
+    world_.ClearLoots();
+    for (const auto& loot : loots_) {
+        world_.AddLoot({loot.GetPos(), Loot::WIDTH, loot.GetId()});
+    }
+
+    PublishSnapshot();
+}
+
+void GameSession::PublishSnapshot() {
+
+    //
+    //  Снимок, который держит только сессия, никто не читает - его можно
+    //  заполнить заново. Читатель, успевший взять снимок до публикации
+    //  следующего, держит свою ссылку, и снимок для него не изменится
+    //
+    std::shared_ptr<SessionSnapshot> snapshot;
+    for (const auto& candidate : snapshots_) {
+        if (candidate.use_count() == 1) {
+            //  все, что читатели делали со снимком, - до того, как они его отпустили
+            std::atomic_thread_fence(std::memory_order_acquire);
+            snapshot = candidate;
+            break;
+        }
+    }
+
+    if (!snapshot) {
+        snapshot = snapshots_.emplace_back(std::make_shared<SessionSnapshot>());
+    }
+
+    snapshot->state_body.store(nullptr, std::memory_order_relaxed);
+
+    //
+    //  resize, а не clear - элементы остаются на месте со своими мешками
+    //
+    snapshot->dogs.resize(dogs_.size());
+    for (size_t slot = 0; slot < dogs_.size(); ++slot) {
+        const auto dog = dogs_[slot];
+        auto& state = snapshot->dogs[slot];
+
+        state.id = dog.GetId();
+        state.pos = dog.GetPos();
+        state.speed = dog.GetSpeed();
+        state.dir = dog.GetDir();
+        state.bag = dog.GetBag();
+        state.score = dog.GetScore();
+    }
+
+    //
+    //  генератор не создает трофеев больше, чем собак, - место под них
+    //  выделяется один раз, а не при каждом новом максимуме
+    //
+    snapshot->loots.reserve(std::max(loots_.size(), dogs_.size()));
+    snapshot->loots.resize(loots_.size());
+    for (size_t slot = 0; slot < loots_.size(); ++slot) {
+        const auto loot = loots_[slot];
+        snapshot->loots[slot] = {loot.GetId(), loot.GetType(), loot.GetPos()};
+    }
+
+    //
+    //  порядок хранилищ меняется при удалении (на место удаленного
+    //  встает последний), поэтому снимок упорядочиваю по идентификаторам
+    //
+    std::sort(snapshot->dogs.begin(), snapshot->dogs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.id < rhs.id;
+    });
+    std::sort(snapshot->loots.begin(), snapshot->loots.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.id < rhs.id;
+    });
+
+    //
+    //  идентификаторы собак растут в порядке входа игроков
+    //
+    const bool players_changed = players_changed_;
+    if (players_changed_) {
+        auto players = std::make_shared<SessionSnapshot::Players>();
+        players->reserve(dogs_.size());
+        for (const auto& dog : dogs_) {
+            players->push_back({dog.GetId(), dog.GetName()});
+        }
+        std::sort(players->begin(), players->end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.id < rhs.id;
+        });
+
+        players_ = std::move(players);
+        players_changed_ = false;
+    }
+    snapshot->players = players_;
+
+    //
+    //  Ничего не изменилось - прежний снимок (и его номер) остается в силе,
+    //  а заполненный снимок вернется в пул
+    //
+    const auto current = snapshot_.load(std::memory_order_relaxed);
+    if (current && !players_changed && current->dogs == snapshot->dogs && current->loots == snapshot->loots) {
+        return;
+    }
+
+    snapshot->generation = ++generation_;
+    if (players_changed) {
+        players_generation_ = generation_;
+    }
+    snapshot->players_generation = players_generation_;
+    snapshot->epoch = epoch_;
+
+    //
+    //  снимок вытесняет из истории тот, что старше его на SNAPSHOT_HISTORY
+    //
+    history_[generation_ % SNAPSHOT_HISTORY].store(snapshot, std::memory_order_release);
+    snapshot_.store(std::move(snapshot), std::memory_order_release);
+}
+
+SessionSnapshot::Ptr GameSession::FindSnapshot(SessionSnapshot::Generation generation) const noexcept {
+
+    auto snapshot = history_[generation % SNAPSHOT_HISTORY].load(std::memory_order_acquire);
+
+    if (snapshot && snapshot->generation == generation) {
+        return snapshot;
+    }
+
+    return nullptr;
 }
 
+namespace {
+
 //
-//  После генерации новых трофеев я получаю массив "элементов", который можно использовать
-//  в алгоритме поиска коллизий
+//  Проход по двум упорядоченным по id массивам: on_change(before, after)
+//  вызывается для исчезнувших (after == nullptr), новых (before == nullptr)
+//  и изменившихся элементов
 //
-std::vector<geom::Item> GameSession::GenerateLoots(TimeInterval timeDelta) {
+template <typename State, typename OnChange>
+void CompareById(const std::vector<State>& before, const std::vector<State>& after, OnChange&& on_change) {
+
+    auto lhs = before.begin();
+    auto rhs = after.begin();
+
+    while (lhs != before.end() || rhs != after.end()) {
+        if (rhs == after.end() || (lhs != before.end() && lhs->id < rhs->id)) {
+            on_change(&*lhs++, nullptr);
+        }
+        else if (lhs == before.end() || rhs->id < lhs->id) {
+            on_change(nullptr, &*rhs++);
+        }
+        else {
+            if (!(*lhs == *rhs)) {
+                on_change(&*lhs, &*rhs);
+            }
+            ++lhs;
+            ++rhs;
+        }
+    }
+}
+
+} // namespace
+
+SessionSnapshot::Delta SessionSnapshot::MakeDelta(const SessionSnapshot& base) const {
+
+    Delta delta;
+
+    CompareById(base.dogs, dogs, [&delta](const DogState* before, const DogState* after) {
+        if (after) {
+            delta.dogs.push_back(after);
+        }
+        else {
+            delta.removed_dogs.push_back(before->id);
+        }
+    });
+
+    CompareById(base.loots, loots, [&delta](const LootState* before, const LootState* after) {
+        if (after) {
+            delta.loots.push_back(after);
+        }
+        else {
+            delta.removed_loots.push_back(before->id);
+        }
+    });
+
+    return delta;
+}
+
+bool GameSession::PostAction(SlotHandle dog, Dog::Direction dir) noexcept {
+    return actions_.TryPush({dog, dir});
+}
+
+//
+//  Собака могла уйти из игры, пока команда ждала в очереди, - тогда
+//  ее устойчивая ссылка уже недействительна и команда пропускается
+//
+void GameSession::ApplyActions() noexcept {
+    actions_.Drain([this](const DogAction& action) {
+        if (auto dog = FindDog(action.dog)) {
+            dog->ChangeDir(action.dir);
+        }
+    });
+}
+
+void GameSession::Tick(TimeInterval timeDelta) {
+
+    //
+    //  Сначала применяю накопившиеся команды игроков, генерирую
+    //  потерянные вещи, затем двигаю собак и собираю трофеи
+    //
+    ApplyActions();
+    GenerateLoots(timeDelta);
+    MoveDogs(timeDelta);
+    GatherLoots();
+}
+
+//
+//  Новые трофеи сразу попадают в мир столкновений (см. AddLoot)
+//
+void GameSession::GenerateLoots(TimeInterval timeDelta) {
 
     const auto loot_count = loot_generator_.Generate(timeDelta, loots_.size(), dogs_.size());
 
@@ -334,48 +811,32 @@ std::vector<geom::Item> GameSession::GenerateLoots(TimeInterval timeDelta) {
         //
         const auto loot_types_count = map_.GetLootTypeCount();
         for (unsigned i = 0; i < loot_count; ++i) {
-            AddLoot(std::rand() % loot_types_count);
+            AddLoot(static_cast<Loot::Type>(GenerateRandomIndex(loot_types_count)));
         }
     }
-
-    std::vector<geom::Item> items;
-
-    for (const auto& loot : loots_) {
-        items.emplace_back(loot.GetPos(), loot.WIDTH, loot.GetId());
-    }
-
-    return items;
 }
 
 //
 //  После перемещения всех собак я получаю массив "собирателей", который затем
 //  используется в алгоритме поиска коллизий
 //
-std::vector<geom::Gatherer> GameSession::MoveDogs(TimeInterval timeDelta) {
-
-    std::vector<geom::Gatherer> gatherers;
-
-    for (Dog& dog : dogs_) {
-        gatherers.emplace_back(dog.Move(map_, timeDelta));
-    }
-
-    return gatherers;
+const std::vector<geom::Gatherer>& GameSession::MoveDogs(TimeInterval timeDelta) {
+    dogs_.Move(map_.GetRoadGraph(), timeDelta, world_.Gatherers());
+    return world_.Gatherers();
 }
 
 bool IsOffice(size_t item_id) {
     return (item_id == 0);
 }
 
-void GameSession::GatherLoots(const LootGathererProvider& provider) {
+void GameSession::GatherLoots() {
 
     //
     //  Найти пересечения собак, трофеев и офисов
     //
-    auto collectionEvents = geom::FindGatherEvents(provider);
+    for (const auto& event : world_.FindEvents()) {
 
-    for (const auto& event : collectionEvents) {
-
-        auto* dog = FindDog(event.gatherer_id);
+        auto dog = FindDog(event.gatherer_id);
 
         assert(dog && "Dog must be always!");
 
@@ -389,7 +850,7 @@ void GameSession::GatherLoots(const LootGathererProvider& provider) {
             //
             //  Пересечение с трофеем, нужно проверить не забрал ли его уже кто-то
             //
-            auto* loot = FindLoot(event.item_id);
+            auto loot = FindLoot(event.item_id);
             if  (!loot) {
                 continue; // ok - трофей уже забрал более быстрый собакен
             }
@@ -399,7 +860,7 @@ void GameSession::GatherLoots(const LootGathererProvider& provider) {
             //  трофей с карты, чтобы больше никто не мог его подобрать
             //  трофей может не подобраться, если мешок уже полон
             //
-            if (dog->TryGatherLoot(*loot)) {
+            if (dog->TryGatherLoot(loot->GetTraits())) {
                 RemoveLoot(loot->GetId());
             }
 
@@ -408,7 +869,7 @@ void GameSession::GatherLoots(const LootGathererProvider& provider) {
 
 }
 
-geom::Point2D GameSession::GenerateRandomPoint(bool randomize_point) const
+geom::Point2D GameSession::GenerateRandomPoint(bool randomize_point)
 {
     const auto &roads = map_.GetRoads();
     if (roads.empty()) {
@@ -433,34 +894,34 @@ geom::Point2D GameSession::GenerateRandomPoint(bool randomize_point) const
 
     //
     //  а здесь все по-взрослому:
-    //  выбираю "случайную" дорогу и на этой дороге
-    //  выбираю "случайную" координату
+    //  одно "случайное" число выбирает дорогу (длинные дороги - чаще)
+    //  и точку на этой дороге
     //
-
-    geom::Point2D pos = {};
-
-    const size_t roads_count = roads.size();
-    const size_t road_index = std::rand() % roads_count;
+    const auto [road_index, offset] = map_.GetSpawnTable().Draw(random_engine_());
     const auto &road = roads[road_index];
     const auto &start = road.GetStart();
     const auto &end = road.GetEnd();
-   
+
     if (road.IsVertical()) {
         //
         //  фиксированный X, изменяемый Y
         //
-        auto y = std::min(start.y, end.y) + (std::rand() % std::abs(start.y - end.y));
-        pos = {static_cast<double>(start.x), static_cast<double>(y)};
-    }
-    else {
-        //
-        //  изменяемый X, фиксированный Y
-        //
-        auto x = std::min(start.x, end.x) + (std::rand() % std::abs(start.x - end.x));
-        pos = {static_cast<double>(x) , static_cast<double>(end.y)};
+        const auto y = std::min(start.y, end.y) + offset * std::abs(start.y - end.y);
+        return {static_cast<double>(start.x), y};
     }
 
-    return pos;
+    //
+    //  изменяемый X, фиксированный Y
+    //
+    const auto x = std::min(start.x, end.x) + offset * std::abs(start.x - end.x);
+    return {x, static_cast<double>(end.y)};
+}
+
+//
+//  "случайное" число в диапазоне [0, count)
+//
+size_t GameSession::GenerateRandomIndex(size_t count) {
+    return static_cast<size_t>(random_engine_() % count);
 }
 
 } // namespace model
\ No newline at end of file
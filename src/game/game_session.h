@@ -1,11 +1,26 @@
 #pragma once
 #include <string>
 #include <string_view>
-#include <deque>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 
 #include "model_units.h"
 #include "loot_generator.h"
 #include "collision_detector.h"
+#include "collision_world.h"
+#include "fixed_point.h"
+#include "mpsc_queue.h"
+#include "road_graph.h"
+#include "slot_map.h"
+#include "small_vector.h"
+#include "xoshiro.h"
 
 namespace model {
 
@@ -25,7 +40,7 @@ public:
     }
 
     geom::Item GetItem(size_t idx) const override {
-        return items_.at(idx);
+        return items_[idx];
     }
 
     size_t GatherersCount() const override {
@@ -33,7 +48,19 @@ public:
     }
 
     geom::Gatherer GetGatherer(size_t idx) const override {
-        return gatherers_.at(idx);
+        return gatherers_[idx];
+    }
+
+    //
+    //  те же элементы непрерывными массивами - для geom::FindGatherEvents без
+    //  виртуальных вызовов
+    //
+    std::span<const geom::Item> GetItems() const noexcept {
+        return items_;
+    }
+
+    std::span<const geom::Gatherer> GetGatherers() const noexcept {
+        return gatherers_;
     }
 
     LootGathererProvider& AddItem(geom::Point2D position, double width, size_t id) {
@@ -114,12 +141,21 @@ private:
 };
 
 
+//
+//  Dog - "запись" о собаке целиком: так собака создается, сохраняется
+//  и восстанавливается. В самой сессии собаки хранятся в DogStorage
+//
 class Dog
 {
 public:
     using Id  = std::uint32_t;
     using Score = std::uint32_t;
-    using Bag = std::vector<Loot::Traits>;
+    //
+    //  вместимость мешка задается картой и обычно невелика (по умолчанию 3),
+    //  поэтому мешок такой вместимости живет прямо в собаке, без кучи
+    //
+    static constexpr size_t INLINE_BAG_CAPACITY = 4;
+    using Bag = util::SmallVector<Loot::Traits, INLINE_BAG_CAPACITY>;
     static constexpr Real WIDTH = 0.6;
 
     enum class Direction : char { 
@@ -150,24 +186,6 @@ public:
     Dog(Dog &&) noexcept = default;
     Dog &operator=(Dog &&) noexcept = default;
 
-    //
-    //  результат каждого перемещения - начальная и конечная точки собаки
-    //  их потом легко поместить в алгоритм поиска коллизий
-    //
-    geom::Gatherer Move(const class Map& map, TimeInterval dt);
-
-    //
-    //  пробую подобрать трофей - но он может не влезть в мешок
-    //  если трофей подобрался - true, нет - false
-    // 
-    bool TryGatherLoot(const Loot& loot);
-
-    //
-    //  сгружаю трофеи на базу, за каждый трофей увеличиваю счет
-    //  на стоимость трофея
-    //
-    void UnloadBag();
-
     Id GetId() const noexcept {
         return id_;
     }
@@ -188,8 +206,6 @@ public:
         return bag_;
     }
 
-    void ChangeDir(Direction dir) noexcept;
-
     Direction GetDir() const noexcept {
         return dir_;
     }
@@ -233,6 +249,489 @@ private:
 };
 
 
+//
+//  Итератор по хранилищу "структура массивов": разыменование
+//  возвращает не ссылку на объект, а легкое представление (view) слота
+//
+template <typename Storage, typename View>
+class StorageIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = View;
+
+    StorageIterator() = default;
+    StorageIterator(Storage& storage, size_t slot) noexcept
+        : storage_(&storage)
+        , slot_(slot) {
+    }
+
+    View operator*() const noexcept {
+        return {*storage_, slot_};
+    }
+
+    StorageIterator& operator++() noexcept {
+        ++slot_;
+        return *this;
+    }
+
+    StorageIterator operator++(int) noexcept {
+        auto prev = *this;
+        ++slot_;
+        return prev;
+    }
+
+    bool operator==(const StorageIterator& other) const noexcept {
+        return (slot_ == other.slot_);
+    }
+
+private:
+    Storage* storage_ = nullptr;
+    size_t slot_ = 0;
+};
+
+
+class LootView;
+
+//
+//  Трофеи сессии в виде "структуры массивов": идентификаторы и координаты,
+//  которые нужны на каждом тике, лежат отдельно от типа и стоимости.
+//  Порядок трофеев не сохраняется - удаленный трофей замещается последним
+//
+class LootStorage {
+public:
+    using const_iterator = StorageIterator<const LootStorage, LootView>;
+
+    size_t size() const noexcept {
+        return ids_.size();
+    }
+
+    bool empty() const noexcept {
+        return ids_.empty();
+    }
+
+    LootView operator[](size_t slot) const noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+    void emplace_back(const Loot& loot);
+
+    //
+    //  слот трофея с заданным идентификатором
+    //
+    std::optional<size_t> Find(Loot::Id id) const noexcept {
+        return slots_.Find(id);
+    }
+
+    void Erase(size_t slot);
+
+    const std::vector<Loot::Id>& GetIds() const noexcept {
+        return ids_;
+    }
+
+private:
+    friend class LootView;
+
+    SlotMap<Loot::Id> slots_;
+    // горячие данные
+    std::vector<Loot::Id> ids_;
+    std::vector<geom::StoredPoint2D> positions_;
+    // холодные данные
+    std::vector<Loot::Type> types_;
+    std::vector<Loot::Value> values_;
+};
+
+//
+//  Представление одного трофея в LootStorage - с теми же методами, что и у Loot
+//
+class LootView {
+public:
+    LootView(const LootStorage& storage, size_t slot) noexcept
+        : storage_(&storage)
+        , slot_(slot) {
+    }
+
+    Loot::Id GetId() const noexcept {
+        return storage_->ids_[slot_];
+    }
+
+    Loot::Type GetType() const noexcept {
+        return storage_->types_[slot_];
+    }
+
+    Loot::Value GetValue() const noexcept {
+        return storage_->values_[slot_];
+    }
+
+    Loot::Traits GetTraits() const noexcept {
+        return {GetId(), GetType(), GetValue()};
+    }
+
+    geom::Point2D GetPos() const noexcept {
+        return geom::LoadPoint(storage_->positions_[slot_]);
+    }
+
+    bool operator==(Loot::Id otherLootId) const noexcept {
+        return (GetId() == otherLootId);
+    }
+
+private:
+    const LootStorage* storage_;
+    size_t slot_;
+};
+
+
+class DogView;
+class DogRef;
+
+//
+//  Собаки сессии в виде "структуры массивов": координаты, скорости,
+//  направления и счетчики времени, по которым каждый тик проходит цикл
+//  перемещения, лежат подряд в своих массивах, а имена, мешки и очки -
+//  в отдельных "холодных" массивах. Порядок собак не сохраняется -
+//  удаленная собака замещается последней, но SlotHandle собаки остается
+//  действительным, пока собака в хранилище
+//
+//  Движение собаки хранится как (точка начала, скорость, время начала)
+//  по часам хранилища, координата вычисляется по ним при чтении. Тик
+//  проходит только по движущимся собакам: стоящей собаке на тике делать
+//  нечего, а время в игре и время простоя тоже считаются от отметок часов
+//
+class DogStorage {
+public:
+    using iterator = StorageIterator<DogStorage, DogRef>;
+    using const_iterator = StorageIterator<const DogStorage, DogView>;
+
+    size_t size() const noexcept {
+        return ids_.size();
+    }
+
+    bool empty() const noexcept {
+        return ids_.empty();
+    }
+
+    DogView operator[](size_t slot) const noexcept;
+    DogRef operator[](size_t slot) noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    iterator begin() noexcept;
+    iterator end() noexcept;
+
+    DogRef emplace_back(const Dog& dog);
+
+    //
+    //  слот собаки с заданным идентификатором или устойчивой ссылкой
+    //
+    std::optional<size_t> Find(Dog::Id id) const noexcept {
+        return slots_.Find(id);
+    }
+
+    std::optional<size_t> Find(SlotHandle handle) const noexcept {
+        return slots_.Find(handle);
+    }
+
+    std::optional<SlotHandle> FindHandle(Dog::Id id) const noexcept {
+        return slots_.FindHandle(id);
+    }
+
+    void Erase(size_t slot);
+
+    //
+    //  Продвинуть часы хранилища на dt и переместить движущихся собак.
+    //  В gatherers (прежнее содержимое стирается) попадают начальная и конечная
+    //  точки каждой собаки, которая двигалась, - их потом легко поместить в
+    //  алгоритм поиска коллизий
+    //
+    void Move(const RoadGraph& roads, TimeInterval dt, std::vector<geom::Gatherer>& gatherers);
+
+    size_t MovingCount() const noexcept {
+        return moving_.size();
+    }
+
+private:
+    friend class DogView;
+    friend class DogRef;
+
+    static constexpr size_t NOT_MOVING = std::numeric_limits<size_t>::max();
+
+    bool IsMoving(size_t slot) const noexcept {
+        return moving_index_[slot] != NOT_MOVING;
+    }
+
+    geom::Point2D GetPosAt(size_t slot, TimeInterval t) const noexcept;
+    TimeInterval GetIdleTime(size_t slot) const noexcept;
+    void StartMoving(size_t slot) noexcept;
+    void StopMoving(size_t slot) noexcept;
+
+    SlotMap<Dog::Id> slots_;
+
+    //
+    //  часы хранилища - сколько игрового времени прошло с его создания
+    //
+    TimeInterval clock_{};
+
+    //
+    //  слоты движущихся собак, для каждой собаки - ее место в этом
+    //  массиве (NOT_MOVING, если собака стоит)
+    //
+    std::vector<size_t> moving_;
+    std::vector<size_t> moving_index_;
+
+    // горячие данные - нужны на каждом тике
+    std::vector<Dog::Id> ids_;
+    //
+    //  точка, из которой собака начала движение в момент origin_times_
+    //  (у стоящей собаки - просто ее координата); координаты и скорости
+    //  хранятся в формате geom::StoredPoint2D/StoredVec2D (см. fixed_point.h)
+    //
+    std::vector<geom::StoredPoint2D> positions_;
+    std::vector<TimeInterval> origin_times_;
+    std::vector<geom::StoredVec2D> speeds_;
+    std::vector<Dog::Direction> directions_;
+    //
+    //  простой до отметки idle_since_; стоящая собака простаивает
+    //  и после нее, движущаяся - нет
+    //
+    std::vector<TimeInterval> idle_times_;
+    std::vector<TimeInterval> idle_since_;
+    //
+    //  отметка часов, от которой считается время в игре
+    //
+    std::vector<TimeInterval> play_origins_;
+    //
+    //  коридор, в котором собака была в прошлый раз - пока собака движется
+    //  вдоль него, искать дорогу заново не нужно
+    //
+    std::vector<RoadGraph::Index> roads_;
+
+    // холодные данные
+    std::vector<std::string> names_;
+    std::vector<Dog::Bag> bags_;
+    std::vector<Dog::Score> scores_;
+    std::vector<Real> max_speeds_;
+    std::vector<size_t> bag_capacities_;
+};
+
+//
+//  Представление одной собаки в DogStorage только для чтения -
+//  с теми же методами, что и у Dog
+//
+class DogView {
+public:
+    DogView(const DogStorage& storage, size_t slot) noexcept
+        : storage_(&storage)
+        , slot_(slot) {
+    }
+
+    Dog::Id GetId() const noexcept {
+        return storage_->ids_[slot_];
+    }
+
+    const std::string& GetName() const noexcept {
+        return storage_->names_[slot_];
+    }
+
+    geom::Point2D GetPos() const noexcept {
+        return storage_->GetPosAt(slot_, storage_->clock_);
+    }
+
+    geom::Vec2D GetSpeed() const noexcept {
+        return geom::LoadVec(storage_->speeds_[slot_]);
+    }
+
+    const Dog::Bag& GetBag() const noexcept {
+        return storage_->bags_[slot_];
+    }
+
+    Dog::Direction GetDir() const noexcept {
+        return storage_->directions_[slot_];
+    }
+
+    Dog::Score GetScore() const noexcept {
+        return storage_->scores_[slot_];
+    }
+
+    size_t GetBagCapacity() const noexcept {
+        return storage_->bag_capacities_[slot_];
+    }
+
+    Real GetMaxSpeed() const noexcept {
+        return storage_->max_speeds_[slot_];
+    }
+
+    TimeInterval GetIdleTime() const noexcept {
+        return storage_->GetIdleTime(slot_);
+    }
+
+    TimeInterval GetPlayTime() const noexcept {
+        return storage_->clock_ - storage_->play_origins_[slot_];
+    }
+
+    bool operator==(Dog::Id otherDogId) const noexcept {
+        return (GetId() == otherDogId);
+    }
+
+protected:
+    const DogStorage* storage_;
+    size_t slot_;
+};
+
+//
+//  Представление одной собаки в DogStorage с возможностью изменения
+//
+class DogRef : public DogView {
+public:
+    DogRef(DogStorage& storage, size_t slot) noexcept
+        : DogView(storage, slot) {
+    }
+
+    void ChangeDir(Dog::Direction dir) noexcept;
+
+    //
+    //  пробую подобрать трофей - но он может не влезть в мешок
+    //  если трофей подобрался - true, нет - false
+    // 
+    bool TryGatherLoot(const Loot::Traits& loot);
+
+    //
+    //  сгружаю трофеи на базу, за каждый трофей увеличиваю счет
+    //  на стоимость трофея
+    //
+    void UnloadBag();
+
+private:
+    //
+    //  DogRef создается только из неконстантного хранилища
+    //
+    DogStorage& Storage() const noexcept {
+        return const_cast<DogStorage&>(*storage_);
+    }
+};
+
+
+//
+//  Команда игрока, ожидающая тика в очереди сессии
+//
+struct DogAction {
+    SlotHandle dog;
+    Dog::Direction dir = Dog::Direction::Stop;
+};
+
+
+//
+//  Неизменяемый снимок состояния сессии - то, что отдают /state и /players.
+//  Сессия публикует снимок после каждого тика (и после входа игрока),
+//  а читатели берут последний опубликованный из любого потока, не трогая
+//  саму сессию и не дожидаясь ее strand
+//
+struct SessionSnapshot {
+    using Ptr = std::shared_ptr<const SessionSnapshot>;
+    using Generation = std::uint64_t;
+    using Epoch = std::uint64_t;
+
+    struct DogState {
+        Dog::Id id = 0;
+        geom::Point2D pos;
+        geom::Vec2D speed;
+        Dog::Direction dir = Dog::Direction::Up;
+        Dog::Bag bag;
+        Dog::Score score = 0;
+
+        [[nodiscard]] bool operator==(const DogState&) const = default;
+    };
+
+    struct LootState {
+        Loot::Id id = 0;
+        Loot::Type type = 0;
+        geom::Point2D pos;
+
+        [[nodiscard]] bool operator==(const LootState&) const = default;
+    };
+
+    struct PlayerInfo {
+        Dog::Id id = 0;
+        std::string name;
+    };
+
+    using Players = std::vector<PlayerInfo>;
+
+    //
+    //  Номер снимка: каждый следующий опубликованный снимок сессии
+    //  получает номер на единицу больше. Снимок публикуется, только если
+    //  состояние изменилось, - пока на карте ничего не происходит, номер
+    //  тоже не меняется. players_generation - номер снимка, в котором
+    //  последний раз менялся список игроков
+    //
+    Generation generation = 0;
+    Generation players_generation = 0;
+
+    //
+    //  Случайное число, выбранное при создании сессии. Номера снимков
+    //  начинаются заново в каждой сессии и после перезапуска сервера,
+    //  поэтому различить их можно только вместе с epoch
+    //
+    Epoch epoch = 0;
+
+    //
+    //  собаки и трофеи - по возрастанию идентификаторов
+    //
+    std::vector<DogState> dogs;
+    std::vector<LootState> loots;
+
+    //
+    //  игроки в порядке входа в игру; список меняется только при входе
+    //  и выходе игроков, поэтому соседние снимки делят его между собой
+    //
+    std::shared_ptr<const Players> players;
+
+    //
+    //  Изменения относительно более старого снимка base: новые и изменившиеся
+    //  собаки и трофеи (указатели на элементы этого снимка) и идентификаторы
+    //  исчезнувших. Снимки упорядочены по идентификаторам, поэтому сравнение -
+    //  один проход по обоим
+    //
+    struct Delta {
+        std::vector<const DogState*> dogs;
+        std::vector<Dog::Id> removed_dogs;
+        std::vector<const LootState*> loots;
+        std::vector<Loot::Id> removed_loots;
+    };
+
+    Delta MakeDelta(const SessionSnapshot& base) const;
+
+    //
+    //  Ответ /state по этому снимку сериализуется один раз - первым
+    //  читателем, остальные берут готовую строку. Если два читателя
+    //  сериализовали одновременно, в снимке остается строка первого
+    //
+    using Body = std::shared_ptr<const std::string>;
+
+    template <typename MakeBody>
+    Body GetStateBody(MakeBody&& make_body) const {
+
+        if (auto body = state_body.load(std::memory_order_acquire)) {
+            return body;
+        }
+
+        Body expected;
+        Body body = std::make_shared<const std::string>(make_body(*this));
+
+        if (!state_body.compare_exchange_strong(expected, body, std::memory_order_acq_rel)) {
+            return expected;
+        }
+
+        return body;
+    }
+
+    //
+    //  сбрасывается, когда снимок заполняется заново
+    //
+    mutable std::atomic<Body> state_body;
+};
+
+
 class GameSession {
     // запрещаю копирование и перемещение, чтобы нельзя было положить объект в нестабильный контейнер
     GameSession(const GameSession &) = delete;
@@ -240,27 +739,86 @@ class GameSession {
     GameSession(GameSession &&) = delete;
     GameSession &operator=(GameSession &&) = delete;
 public:
-    using Dogs = std::deque<Dog>;
-    using Loots = std::deque<Loot>;
+    using Dogs = DogStorage;
+    using Loots = LootStorage;
+    using RandomEngine = util::Xoshiro256;
+    using Seed = RandomEngine::result_type;
+
+    static constexpr Seed DEFAULT_RANDOM_SEED = RandomEngine::default_seed;
+
+    //
+    //  сколько команд игроков сессия может накопить до ближайшего тика
+    //
+    static constexpr size_t ACTION_QUEUE_CAPACITY = 4096;
+
+    //
+    //  сколько последних снимков сессия хранит для ответов с изменениями
+    //  (/state?since=...) - при тике 50мс это меньше секунды истории
+    //
+    static constexpr size_t SNAPSHOT_HISTORY = 16;
 
-    GameSession(const class Map &map, TimeInterval base_interval, double probability);
+    //
+    //  У каждой сессии свой генератор случайных чисел и свои счетчики
+    //  идентификаторов - сессии не делят никакого общего состояния и могут
+    //  обрабатываться параллельно, а при одинаковом random_seed ведут себя одинаково
+    //
+    GameSession(const class Map &map, TimeInterval base_interval, double probability, Seed random_seed = DEFAULT_RANDOM_SEED);
 
-    Dog* AddDog(const std::string& dogName, bool randomize_spawn_point);
-    Dog* FindDog(Dog::Id id) const noexcept;
+    DogRef AddDog(const std::string& dogName, bool randomize_spawn_point);
+    std::optional<DogRef> FindDog(Dog::Id id) noexcept;
+    std::optional<DogView> FindDog(Dog::Id id) const noexcept;
+    std::optional<DogRef> FindDog(SlotHandle handle) noexcept;
+    std::optional<SlotHandle> FindDogHandle(Dog::Id id) const noexcept;
     void RemoveDog(Dog::Id id);
-    Loot *FindLoot(Loot::Id id) const noexcept;
+    std::optional<LootView> FindLoot(Loot::Id id) const noexcept;
     void  RemoveLoot(Loot::Id id);
     void  SetDogs(Dogs&& dogs, Dog::Id next_dog_id);
     void  SetLoots(Loots&& loots, Loot::Id next_loot_id);
 
     //
-    //  Результат генерации трофеев - массив "элементов" для алгоритма
-    //  поиска коллизий, а результат перемещения всех собак на карте -
-    //  массив сборщиков
+    //  Команда игрока (смена направления собаки) кладется в очередь сессии
+    //  без блокировок и из любого потока, а применяется в strand сессии
+    //  в начале тика. Если очередь полна - false
+    //
+    bool PostAction(SlotHandle dog, Dog::Direction dir) noexcept;
+    void ApplyActions() noexcept;
+
+    //
+    //  Один тик игры: применить команды игроков, сгенерировать трофеи, переместить собак и собрать
+    //  то, что они задели по пути. Все шаги работают с миром столкновений
+    //  сессии, поэтому в установившемся режиме память не выделяется
+    //
+    void Tick(TimeInterval timeDelta);
+
     //
-    std::vector<geom::Item> GenerateLoots(TimeInterval timeDelta);
-    std::vector<geom::Gatherer> MoveDogs(TimeInterval timeDelta);
-    void GatherLoots(const LootGathererProvider& provider);
+    //  Шаги тика по отдельности. Результат перемещения всех собак на карте -
+    //  массив сборщиков (действителен до следующего перемещения), его же
+    //  использует GatherLoots
+    //
+    void GenerateLoots(TimeInterval timeDelta);
+    const std::vector<geom::Gatherer>& MoveDogs(TimeInterval timeDelta);
+    void GatherLoots();
+
+    //
+    //  Опубликовать снимок текущего состояния (только в strand сессии).
+    //  Снимки переиспользуются: снимок, который уже никто не читает,
+    //  заполняется заново, поэтому в установившемся режиме память не выделяется.
+    //  Если состояние не изменилось с прошлого снимка, новый не публикуется
+    //
+    void PublishSnapshot();
+
+    //
+    //  последний опубликованный снимок - можно вызывать из любого потока
+    //
+    SessionSnapshot::Ptr GetSnapshot() const noexcept {
+        return snapshot_.load(std::memory_order_acquire);
+    }
+
+    //
+    //  снимок с номером generation, если он еще в истории сессии,
+    //  иначе nullptr - тоже можно вызывать из любого потока
+    //
+    SessionSnapshot::Ptr FindSnapshot(SessionSnapshot::Generation generation) const noexcept;
     
     const class Map &GetMap() const noexcept {
         return map_;
@@ -274,25 +832,43 @@ public:
         return loots_;
     }
 
-    static Dog::Id GetNextDogId() noexcept {
+    Dog::Id GetNextDogId() const noexcept {
         return next_dog_id_;
     }
 
-    static Loot::Id GetNextLootId() noexcept {
+    Loot::Id GetNextLootId() const noexcept {
         return next_loot_id_;
     }
 
 private:
-    geom::Point2D GenerateRandomPoint(bool randomize_point) const;
+    geom::Point2D GenerateRandomPoint(bool randomize_point);
+    size_t GenerateRandomIndex(size_t count);
     void AddLoot(Loot::Type type);
 
 private:
-    static Dog::Id next_dog_id_;
-    static Loot::Id next_loot_id_;
+    //
+    //  Идентификаторы начинаю с единицы, потому что ноль
+    //  зарезервирован под идентификатор(ы) базы
+    //
+    Dog::Id next_dog_id_ = 1;
+    Loot::Id next_loot_id_ = 1;
+    RandomEngine random_engine_;
     const class Map &map_;
     Dogs dogs_;
     Loots loots_;
+    CollisionWorld world_;
     loot_gen::LootGenerator loot_generator_;
+
+    util::MpscQueue<DogAction> actions_{ACTION_QUEUE_CAPACITY};
+
+    std::atomic<SessionSnapshot::Ptr> snapshot_;
+    std::array<std::atomic<SessionSnapshot::Ptr>, SNAPSHOT_HISTORY> history_;
+    const SessionSnapshot::Epoch epoch_;
+    SessionSnapshot::Generation generation_ = 0;
+    SessionSnapshot::Generation players_generation_ = 0;
+    std::vector<std::shared_ptr<SessionSnapshot>> snapshots_;
+    std::shared_ptr<const SessionSnapshot::Players> players_;
+    bool players_changed_ = true;
 };
 
 } // namespace model
\ No newline at end of file
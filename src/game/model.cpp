@@ -1,4 +1,5 @@
 #include "../sdk.h"
+#include <algorithm>
 #include <stdexcept>
 #include "model.h"
 
@@ -6,11 +7,12 @@
 namespace model {
 using namespace std::literals;
 
-Map::Map(Id id, std::string name, Real dog_speed, size_t bag_capacity) noexcept
+Map::Map(Id id, std::string name, Real dog_speed, size_t bag_capacity, size_t max_dogs) noexcept
 : id_(std::move(id))
 , name_(std::move(name))
 , dog_speed_(dog_speed)
-, bag_capacity_(bag_capacity) {
+, bag_capacity_(bag_capacity)
+, max_dogs_(max_dogs) {
 }
 
 void Map::AddOffice(Office&& office) {
@@ -29,10 +31,40 @@ void Map::AddOffice(Office&& office) {
     }
 }
 
- void Map::AddRoad(Road&& road) {
+void Map::AddRoad(Road&& road) {
     roads_.emplace_back(std::move(road));
 }
 
+void Map::BuildRoadGraph() {
+
+    std::vector<RoadGraph::Segment> segments;
+    segments.reserve(roads_.size());
+
+    std::vector<double> lengths;
+    lengths.reserve(roads_.size());
+
+    for (const auto& road : roads_) {
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+
+        if (road.IsHorizontal()) {
+            segments.push_back({true, static_cast<double>(start.y),
+                static_cast<double>(std::min(start.x, end.x)), static_cast<double>(std::max(start.x, end.x))});
+        }
+        else {
+            segments.push_back({false, static_cast<double>(start.x),
+                static_cast<double>(std::min(start.y, end.y)), static_cast<double>(std::max(start.y, end.y))});
+        }
+    }
+
+    for (const auto& segment : segments) {
+        lengths.push_back(segment.to - segment.from);
+    }
+
+    road_graph_.Build(segments, Road::ALIGNMENT);
+    spawn_table_.Build(lengths);
+}
+
 void Map::AddBuilding(Building&& building) {
     buildings_.emplace_back(std::move(building));
 }
@@ -69,6 +101,10 @@ void Game::SetTicker(Ticker::Ptr ticker) {
     ticker_ = ticker;
 }
 
+void Game::SetRandomSeed(GameSession::Seed random_seed) noexcept {
+    random_seed_ = random_seed;
+}
+
 const Map* Game::FindMap(const Map::Id& id) const noexcept {
     if (auto it = map_id_to_index_.find(id); it != map_id_to_index_.end()) {
         return &maps_.at(it->second);
@@ -76,33 +112,114 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
     return nullptr;
 }
 
-GameSession* Game::FindSession(const Map::Id &id) noexcept
-{
-    if (auto it = sessions_.find(id); it != sessions_.end()) {
-        return &it->second;
+Game::Instance::Instance(const Map& map, TimeInterval base_interval, Real probability, GameSession::Seed random_seed, size_t seats)
+: session(map, base_interval, probability, random_seed)
+, seats(seats) {
+}
+
+GameSession *Game::TakeSeat(const Map::Id &id) {
+
+    const Map* map = FindMap(id);
+    if (!map) {
+        return nullptr;
     }
 
-    return nullptr;
+    const size_t max_dogs = map->GetMaxDogs();
+
+    std::lock_guard lock(sessions_lock_);
+
+    auto& instances = sessions_[id];
+
+    //
+    //  Из сессий, где еще есть места, выбираю наименее загруженную -
+    //  так игроки распределяются между сессиями равномерно
+    //
+    Instance* target = nullptr;
+    for (auto& instance : instances) {
+        if (max_dogs != 0 && instance.seats >= max_dogs) {
+            continue;
+        }
+        if (!target || instance.seats < target->seats) {
+            target = &instance;
+        }
+    }
+
+    if (!target) {
+        AddInstance(*map, instances, 1);
+        return &instances.back().session;
+    }
+
+    ++target->seats;
+
+    return &target->session;
+}
+
+void Game::FreeSeat(const GameSession &session) noexcept {
+
+    std::lock_guard lock(sessions_lock_);
+
+    if (auto it = sessions_.find(session.GetMap().GetId()); it != sessions_.end()) {
+        for (auto& instance : it->second) {
+            if (&instance.session == &session && instance.seats > 0) {
+                --instance.seats;
+                break;
+            }
+        }
+    }
 }
 
-GameSession *Game::AddSession(const Map::Id &id) {
+GameSession *Game::AddSession(const Map::Id &id, size_t seats) {
+
     const Map* map = FindMap(id);
-    if (map) {
-        return AddSession(*map);
+    if (!map) {
+        return nullptr;
     }
 
-    return nullptr;
+    std::lock_guard lock(sessions_lock_);
+
+    return AddInstance(*map, sessions_[id], seats);
 }
 
-GameSession *Game::AddSession(const Map &map) {
+Game::SessionsList Game::GetSessions() {
 
-    auto [it, inserted] = sessions_.try_emplace(map.GetId(), map, base_interval_, probability_);
+    SessionsList sessions;
 
-    //
-    //  если для этой карты уже есть сессия - не считаю ошибкой
-    //
+    std::lock_guard lock(sessions_lock_);
+
+    for (const auto& map : maps_) {
+        if (auto it = sessions_.find(map.GetId()); it != sessions_.end()) {
+            for (auto& instance : it->second) {
+                sessions.push_back(&instance.session);
+            }
+        }
+    }
+
+    return sessions;
+}
+
+//
+//  вызывается под sessions_lock_
+//
+GameSession *Game::AddInstance(const Map &map, Instances &instances, size_t seats) {
+
+    auto& instance = instances.emplace_back(map, base_interval_, probability_, MakeSessionSeed(map, instances.size()), seats);
+
+    return &instance.session;
+}
+
+//
+//  Зерно генератора сессии зависит только от общего зерна игры, от
+//  номера карты в конфигурации и от номера сессии карты, но не от
+//  порядка создания сессий разных карт
+//
+GameSession::Seed Game::MakeSessionSeed(const Map& map, size_t instance) const noexcept {
+
+    GameSession::Seed map_index = 0;
+    if (auto it = map_id_to_index_.find(map.GetId()); it != map_id_to_index_.end()) {
+        map_index = it->second;
+    }
 
-    return &it->second;
+    return random_seed_ ^ ((map_index + 1) * 0x9E3779B97F4A7C15ull) ^ (instance * 0xBF58476D1CE4E5B9ull);
 }
 
 
@@ -3,11 +3,14 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <deque>
 
 #include "tagged.h"
 #include "loot_generator.h"
 #include "model_units.h"
+#include "road_graph.h"
+#include "spawn_table.h"
 #include "game_session.h"
 #include "ticker.h"
 
@@ -118,7 +121,10 @@ public:
     using Buildings = std::vector<Building>;
     using Offices = std::vector<Office>;
 
-    Map(Id id, std::string name, Real dog_speed, size_t bag_capacity) noexcept;
+    //
+    //  max_dogs - сколько собак помещается в одну сессию карты, 0 - без ограничений
+    //
+    Map(Id id, std::string name, Real dog_speed, size_t bag_capacity, size_t max_dogs = 0) noexcept;
 
     // пришлось оставить - иначе никак
     Map(Map &&) noexcept = default;
@@ -139,6 +145,20 @@ public:
         return roads_;
     }
 
+    //
+    //  граф дорог, по которому двигаются собаки (см. BuildRoadGraph)
+    //
+    const RoadGraph& GetRoadGraph() const noexcept {
+        return road_graph_;
+    }
+
+    //
+    //  таблица выбора дороги для случайной точки появления (см. BuildRoadGraph)
+    //
+    const SpawnTable& GetSpawnTable() const noexcept {
+        return spawn_table_;
+    }
+
     const Offices& GetOffices() const noexcept {
         return offices_;
     }
@@ -151,6 +171,10 @@ public:
         return bag_capacity_;
     }
 
+    size_t GetMaxDogs() const noexcept {
+        return max_dogs_;
+    }
+
     size_t GetLootTypeCount() const noexcept {
         return loot_values_.size();
     }
@@ -169,6 +193,12 @@ public:
 
     void AddRoad(Road&& road);
 
+    //
+    //  собрать граф дорог и таблицу точек появления - вызывается один раз,
+    //  когда все дороги уже добавлены
+    //
+    void BuildRoadGraph();
+
     void AddBuilding(Building&& building);
 
     void AddOffice(Office&& office);
@@ -183,6 +213,8 @@ private:
     Id id_;
     std::string name_;
     Roads roads_;
+    RoadGraph road_graph_;
+    SpawnTable spawn_table_;
     Buildings buildings_;
 
     OfficeIdToIndex warehouse_id_to_index_;
@@ -190,28 +222,66 @@ private:
 
     Real dog_speed_;
     size_t bag_capacity_;
+    size_t max_dogs_;
     std::vector<Loot::Value> loot_values_;
     std::string frontend_loot_types_;
 };
 
 class Game {
+    // сессии создаются по ходу игры из разных потоков, поэтому Game живет только в Game::Ptr
+    Game(const Game&) = delete;
+    Game& operator=(const Game&) = delete;
 public:
     using Ptr = std::shared_ptr<Game>;
     using Maps = std::deque<Map>;
+    using SessionsList = std::vector<GameSession*>;
 
     Game(TimeInterval base_interval, Real probability, TimeInterval dog_retirement_time);
 
     void SetTicker(Ticker::Ptr ticker);
 
+    //
+    //  общее зерно генераторов случайных чисел сессий; задается до того,
+    //  как появятся сессии - при одинаковом зерне и одинаковых действиях
+    //  игроков игра идет одинаково
+    //
+    void SetRandomSeed(GameSession::Seed random_seed) noexcept;
+
     void AddMap(Map &&map);
     const Map* FindMap(const Map::Id &id) const noexcept;
     const Maps& GetMaps() const noexcept {
         return maps_;
     }
 
-    GameSession *FindSession(const Map::Id &id) noexcept;
-    GameSession *AddSession(const Map::Id &id);
-    GameSession *AddSession(const Map &map);
+    //
+    //  У карты может быть несколько сессий: когда во всех уже есть
+    //  Map::GetMaxDogs() собак, для новых игроков открывается еще одна.
+    //  Места в сессиях учитываются здесь, чтобы выбирать сессию, не трогая
+    //  ее саму. Все методы ниже потокобезопасны, а вот с самой сессией
+    //  можно работать только в ее strand (см. app::Application)
+    //
+
+    //
+    //  занять место в наименее загруженной из неполных сессий карты
+    //  (или в новой сессии), nullptr - карты нет
+    //
+    GameSession *TakeSeat(const Map::Id &id);
+
+    //
+    //  освободить место, занятое TakeSeat (собака покинула сессию)
+    //
+    void FreeSeat(const GameSession &session) noexcept;
+
+    //
+    //  новая сессия карты, в которой уже заняты seats мест
+    //  (используется при восстановлении состояния)
+    //
+    GameSession *AddSession(const Map::Id &id, size_t seats = 0);
+
+    //
+    //  все сессии в порядке карт в конфигурации, сессии одной карты - в порядке создания
+    //
+    SessionsList GetSessions();
 
     TimeInterval GetRetirementTime() const noexcept {
         return dog_retirement_time_;
@@ -221,15 +291,32 @@ private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
     using SessionIdHasher = util::TaggedHasher<Map::Id>;
-    using Sessions = std::unordered_map<Map::Id, GameSession, SessionIdHasher>;
+
+    struct Instance {
+        Instance(const Map& map, TimeInterval base_interval, Real probability, GameSession::Seed random_seed, size_t seats);
+
+        GameSession session;
+        size_t seats;
+    };
+
+    //
+    //  deque - сессия не перемещается, на нее ссылаются игроки и strand-ы
+    //
+    using Instances = std::deque<Instance>;
+    using Sessions = std::unordered_map<Map::Id, Instances, SessionIdHasher>;
+
+    GameSession *AddInstance(const Map &map, Instances &instances, size_t seats);
+    GameSession::Seed MakeSessionSeed(const Map& map, size_t instance) const noexcept;
 
     Maps maps_;
     MapIdToIndex map_id_to_index_;
+    std::mutex sessions_lock_;
     Sessions sessions_;
     Ticker::Ptr ticker_;
     TimeInterval base_interval_;
     Real probability_;
     TimeInterval dog_retirement_time_;
+    GameSession::Seed random_seed_ = GameSession::DEFAULT_RANDOM_SEED;
 };
 
 }  // namespace model
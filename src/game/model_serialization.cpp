@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include <cstdio>
+#include <mutex>
 #include "model_serialization.h"
 
 namespace serialization {
@@ -33,7 +34,7 @@ void SerializationListener::OnTick(model::TimeInterval timeDelta) noexcept {
             return;
         }
 
-        SaveGameState(state_file_, game_, application_);
+        SaveGameState(state_file_, application_);
 
         time_since_save_ = {};
     }
@@ -41,7 +42,7 @@ void SerializationListener::OnTick(model::TimeInterval timeDelta) noexcept {
     }
 }
 
-void SaveGameState(const std::filesystem::path &state_file, model::Game::Ptr game, app::Application::Ptr app) noexcept
+void SaveGameState(const std::filesystem::path &state_file, app::Application::Ptr app) noexcept
 {
 
     try
@@ -59,35 +60,32 @@ void SaveGameState(const std::filesystem::path &state_file, model::Game::Ptr gam
         //  всех картах — собаках и потерянных предметах;
         //
 
-        const auto &maps = game->GetMaps();
-
-        std::vector<SessionRepr> sessions;
-
-        for (const auto &map : maps)
-        {
-
-            const auto *session = game->FindSession(map.GetId());
-            if (!session)
-                continue;
-
-            sessions.emplace_back(*session);
-        }
-
-        output_archive << sessions;
-
         //
         //  - информацию о токенах и идентификаторах пользователей,
         //  вошедших в игру.
         //
+        //  Каждая сессия и ее игроки сохраняются в strand этой сессии,
+        //  поэтому игроки всегда соответствуют собакам в сессии
+        //
+        std::mutex lock;
+        std::vector<SessionRepr> sessions;
+        std::vector<PlayerRepr> players_and_tokens;
 
-        auto tokens = app->GetTokensPlayers();
+        app->ForEachSession([&](const model::GameSession& session) {
 
-        std::vector<PlayerRepr> players_and_tokens;
+            SessionRepr session_repr{session};
+            auto tokens = app->GetTokensPlayers(session);
 
-        for (const auto &token : tokens) {
-            players_and_tokens.emplace_back(token);
-        }
+            std::lock_guard guard(lock);
 
+            const size_t session_index = sessions.size();
+            sessions.emplace_back(std::move(session_repr));
+            for (const auto &token : tokens) {
+                players_and_tokens.emplace_back(token, session_index);
+            }
+        });
+
+        output_archive << sessions;
         output_archive << players_and_tokens;
 
         //
@@ -126,7 +124,14 @@ void LoadGameState(const std::filesystem::path& state_file, model::Game::Ptr gam
     }
     
     
-    boost::archive::text_iarchive input_archive{input_stream};
+    RestoreGameState(input_stream, game, [&app](app::Token token, app::Player&& player) {
+        app->AddPlayer(std::move(token), std::move(player));
+    });
+}
+
+void RestoreGameState(std::istream& input, model::Game::Ptr game, const AddPlayerHandler& add_player) {
+
+    boost::archive::text_iarchive input_archive{input};
 
     std::vector<SessionRepr> sessions;
 
@@ -136,16 +141,16 @@ void LoadGameState(const std::filesystem::path& state_file, model::Game::Ptr gam
 
     input_archive >> players_and_tokens;
 
-    for (auto& session_repr : sessions) {
-        auto* session = session_repr.Restore(game);
+    for (size_t session_index = 0; session_index < sessions.size(); ++session_index) {
+        auto* session = sessions[session_index].Restore(game);
         if (!session)
             continue;
 
         for (const auto& player_and_token : players_and_tokens) {
-            if (player_and_token.GetMapId() != session->GetMap().GetId())
+            if (!player_and_token.BelongsTo(session_index, session->GetMap().GetId()))
                 continue;
 
-            app->AddPlayer(player_and_token.RestoreToken(), player_and_token.RestorePlayer(*session));
+            add_player(player_and_token.RestoreToken(), player_and_token.RestorePlayer(*session));
             
         }
         
@@ -1,4 +1,8 @@
 #include <filesystem>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <boost/serialization/version.hpp>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/deque.hpp>
 
@@ -64,14 +68,18 @@ class DogRepr {
 public:
     DogRepr() = default;
 
-    explicit DogRepr(const model::Dog& dog)
+    //
+    //  подходит как model::Dog, так и представление собаки в сессии model::DogView
+    //
+    template <typename DogLike>
+    explicit DogRepr(const DogLike& dog)
         : id_(dog.GetId())
         , name_(dog.GetName())
         , pos_(dog.GetPos())
         , speed_(dog.GetSpeed())
         , direction_(dog.GetDir())
         , score_(dog.GetScore())
-        , bag_content_(dog.GetBag()) 
+        , bag_content_(dog.GetBag().begin(), dog.GetBag().end()) 
         , max_speed_(dog.GetMaxSpeed()) 
         , bag_capacity_(dog.GetBagCapacity()) 
         , play_time_(dog.GetPlayTime().count())
@@ -79,7 +87,8 @@ public:
     }
 
     [[nodiscard]] model::Dog Restore() const {
-        return {id_, name_, pos_, speed_, direction_, bag_content_, score_, max_speed_, bag_capacity_, play_time_, idle_time_};
+        const model::Dog::Bag bag(bag_content_.begin(), bag_content_.end());
+        return {id_, name_, pos_, speed_, direction_, bag, score_, max_speed_, bag_capacity_, play_time_, idle_time_};
     }
 
     template <typename Archive>
@@ -104,7 +113,10 @@ private:
     geom::Vec2D speed_;
     model::Dog::Direction direction_ = model::Dog::Direction::Up;
     model::Dog::Score score_ = 0;
-    model::Dog::Bag bag_content_;
+    //
+    //  в файле мешок хранится как обычный вектор - формат сохранения не меняется
+    //
+    std::vector<model::Loot::Traits> bag_content_;
     model::Real max_speed_ = 0.;
     size_t bag_capacity_ = 0;
     model::TimeInterval::rep play_time_ = 0;
@@ -119,7 +131,11 @@ class LootRepr {
 public:
     LootRepr() = default;
 
-    explicit LootRepr(const model::Loot& loot)
+    //
+    //  подходит как model::Loot, так и представление трофея в сессии model::LootView
+    //
+    template <typename LootLike>
+    explicit LootRepr(const LootLike& loot)
         : traits_(loot.GetTraits())
         , pos_(loot.GetPos()) {
     }
@@ -150,8 +166,8 @@ public:
 
     explicit SessionRepr(const model::GameSession& session)
         : id_(session.GetMap().GetId())
-        , next_dog_id_(model::GameSession::GetNextDogId())
-        , next_loot_id_(model::GameSession::GetNextLootId()) {
+        , next_dog_id_(session.GetNextDogId())
+        , next_loot_id_(session.GetNextLootId()) {
 
             const auto& dogs = session.GetDogs();
             for (const auto& dog : dogs) {
@@ -166,7 +182,11 @@ public:
 
     [[nodiscard]] model::GameSession* Restore(model::Game::Ptr game) {
 
-        if (auto* session = game->AddSession(id_); session != nullptr) {
+        //
+        //  каждая сохраненная сессия восстанавливается в отдельную сессию карты,
+        //  места в ней заняты восстановленными собаками
+        //
+        if (auto* session = game->AddSession(id_, dogs_.size()); session != nullptr) {
             model::GameSession::Dogs restored_dogs;
             model::GameSession::Loots restored_loots;
 
@@ -209,13 +229,22 @@ private:
 };
 
 
+//
+// PlayerRepr - токен игрока и ссылка на его собаку. У карты может быть несколько
+//  сессий, поэтому игрок ссылается на сессию по ее номеру в сохраненном списке
+//  сессий. В файлах версии 0 номера сессии нет - там у каждой карты была
+//  одна сессия, и игрок находится по идентификатору карты
+//
 class PlayerRepr {
 public:
+    static constexpr size_t NO_SESSION = std::numeric_limits<size_t>::max();
+
     PlayerRepr() = default;
-    explicit PlayerRepr(const std::pair<app::Token, const app::Player*>& token_and_player)
+    PlayerRepr(const std::pair<app::Token, const app::Player*>& token_and_player, size_t session_index)
     : token_(token_and_player.first)
     , player_id_(token_and_player.second->GetId())
-    , player_map_id_(token_and_player.second->GetMap().GetId()) {
+    , player_map_id_(token_and_player.second->GetMap().GetId())
+    , session_index_(session_index) {
 
     }
 
@@ -231,17 +260,31 @@ public:
         return player_map_id_;
     }
 
+    //
+    //  игрок из сессии с номером session_index в сохраненном списке сессий
+    //
+    bool BelongsTo(size_t session_index, const model::Map::Id& map_id) const noexcept {
+        if (session_index_ == NO_SESSION) {
+            return player_map_id_ == map_id;
+        }
+        return session_index_ == session_index;
+    }
+
     template <typename Archive>
-    void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
+    void serialize(Archive& ar, const unsigned version) {
         ar& token_;
         ar& player_id_;
         ar& player_map_id_;
+        if (version > 0) {
+            ar& session_index_;
+        }
     }
 
 private:
     app::Token  token_{""s};
     app::Player::Id player_id_{0};
     model::Map::Id player_map_id_{""s};
+    size_t session_index_ = NO_SESSION;
 };
 
 
@@ -268,7 +311,17 @@ private:
     TimeInterval time_since_save_{};
 };
 
-void SaveGameState(const std::filesystem::path& state_file, model::Game::Ptr game, app::Application::Ptr app) noexcept;
+void SaveGameState(const std::filesystem::path& state_file, app::Application::Ptr app) noexcept;
 void LoadGameState(const std::filesystem::path& state_file, model::Game::Ptr game, app::Application::Ptr app);
 
+//
+//  Восстановить сессии и их игроков из сохраненного состояния: каждая
+//  сохраненная сессия - в новую сессию своей карты, а каждый игрок
+//  передается в add_player вместе с токеном (в сервере - Application::AddPlayer)
+//
+using AddPlayerHandler = std::function<void(app::Token token, app::Player&& player)>;
+void RestoreGameState(std::istream& input, model::Game::Ptr game, const AddPlayerHandler& add_player);
+
 }  // namespace serialization
+
+BOOST_CLASS_VERSION(::serialization::PlayerRepr, 1)
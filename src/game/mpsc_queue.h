@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace util {
+
+//
+//  Ограниченная очередь без блокировок: класть можно из любого числа
+//  потоков, забирать - только из одного (multi-producer single-consumer).
+//  Кольцевой буфер, у каждой ячейки свой счетчик: по нему писатель видит,
+//  что ячейка свободна, а читатель - что она уже заполнена (очередь Вьюкова).
+//  Память выделяется один раз в конструкторе; в полную очередь положить
+//  ничего нельзя - TryPush вернет false
+//
+template <typename T>
+class MpscQueue {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "MpscQueue holds trivially copyable types only");
+public:
+    //
+    //  вместимость округляется вверх до степени двойки
+    //
+    explicit MpscQueue(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+        , cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    //
+    //  можно вызывать из любого потока
+    //
+    bool TryPush(const T& value) noexcept {
+
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                //  ячейку еще не освободил читатель - очередь полна
+                return false;
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    //
+    //  Забрать все, что уже положено, и передать по порядку в fn;
+    //  вызывается только из одного потока (или strand) одновременно
+    //
+    template <typename Fn>
+    size_t Drain(Fn&& fn) {
+
+        size_t count = 0;
+
+        for (;;) {
+            Cell& cell = cells_[head_ & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                break;
+            }
+
+            const T value = cell.value;
+            cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            ++count;
+
+            fn(value);
+        }
+
+        return count;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    //
+    //  писатели и читатель работают с разными концами очереди -
+    //  счетчики на разных линиях кэша, чтобы не мешали друг другу
+    //
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    alignas(CACHE_LINE) size_t head_ = 0;
+};
+
+} // namespace util
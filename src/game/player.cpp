@@ -1,5 +1,6 @@
 #include "../sdk.h"
 #include "player.h"
+#include <algorithm>
 #include <iostream>
 
 namespace app {
@@ -8,18 +9,19 @@ namespace app {
 Player::Player(model::GameSession &session, Id id)
 : session_(&session)
 , id_(id)
+, dog_(session.FindDogHandle(id).value_or(model::SlotHandle{}))
 {    
 }
 
-model::Dog* Player::GetDog() const noexcept {
-    return session_->FindDog(id_);
+std::optional<model::DogRef> Player::GetDog() const noexcept {
+    return session_->FindDog(dog_);
 }
 
 const std::string& Player::GetName() const noexcept {
 
     static const std::string UNKNOWN_NAME{};
 
-    if (auto* dog = GetDog()) {
+    if (auto dog = GetDog()) {
         return dog->GetName();
     }
 
@@ -28,7 +30,7 @@ const std::string& Player::GetName() const noexcept {
 
 model::TimeInterval Player::GetIdleTime() const noexcept {
 
-    if (auto* dog = GetDog()) {
+    if (auto dog = GetDog()) {
         return dog->GetIdleTime();
     }
 
@@ -37,7 +39,7 @@ model::TimeInterval Player::GetIdleTime() const noexcept {
 
 PlayerStatistics Player::GetStatistics() const noexcept {
     
-    if (auto* dog = GetDog()) {
+    if (auto dog = GetDog()) {
         return {dog->GetName(), dog->GetScore(), dog->GetPlayTime()};
     }
 
@@ -46,12 +48,11 @@ PlayerStatistics Player::GetStatistics() const noexcept {
 
 //
 //  const здесь выглядит странно - но я же меняю направление
-//  не у игрока, а у его собаки :)
+//  не у игрока, а у его собаки :) Собаку здесь не трогаю: проверит,
+//  жива ли она, и повернет ее сама сессия, когда применит команду
 //
-void Player::ChangeDir(model::Dog::Direction dir) const noexcept {
-    if (auto* dog = GetDog()) {
-        dog->ChangeDir(dir);
-    }
+bool Player::PostAction(model::Dog::Direction dir) const noexcept {
+    return session_->PostAction(dog_, dir);
 }
 
 void Player::DismissDog() {
@@ -64,6 +65,8 @@ void Players::AddPlayer(Token token, model::GameSession& session, model::Dog::Id
 }
 
 void Players::AddPlayer(Token token, Player&& player) {
+
+    std::unique_lock lock(lock_);
         
     auto& ref = players_.emplace_back(std::move(player));
 
@@ -82,7 +85,12 @@ void Players::AddPlayer(Token token, Player&& player) {
 
 PlayerStatistics Players::RemovePlayer(const Token& token) {
 
-    Player* player = RemoveToken(token);
+    Player* player = nullptr;
+    {
+        std::unique_lock lock(lock_);
+        player = RemoveToken(token);
+    }
+
     if (!player) {
         throw std::logic_error("Token not found");
     }
@@ -96,7 +104,10 @@ PlayerStatistics Players::RemovePlayer(const Token& token) {
     //  Удалить из сессии собаку игрока, а затем уже удалить самого игрока
     //
     player->DismissDog();
-    RemovePlayer(player->GetId());
+    {
+        std::unique_lock lock(lock_);
+        RemovePlayer(player);
+    }
 
     //
     //  вернуть остатки для записи в БД
@@ -118,24 +129,48 @@ Player *Players::RemoveToken(const Token& token) {
     return player;
 }
 
-void Players::RemovePlayer(Player::Id id) {
+//
+//  Идентификаторы собак уникальны только в пределах сессии, поэтому
+//  игрок удаляется по адресу, а не по идентификатору
+//
+void Players::RemovePlayer(const Player* player) {
+
+    auto it = std::find_if(players_.begin(), players_.end(), [player](const Player& p) {
+        return &p == player;
+    });
 
-    if (auto it = std::find(players_.begin(), players_.end(), id); it != players_.end()) {
+    if (it != players_.end()) {
         players_.erase(it);
     }
 }
 
-Player *Players::FindPlayer(const Token &token) const noexcept
+const model::GameSession* Players::FindSession(const Token &token) const noexcept
 {
+    std::shared_lock lock(lock_);
+
     if (auto it = token_to_player_.find(token); it != token_to_player_.end()) {
-        return it->second;
+        return &it->second->GetSession();
     }
 
     return nullptr;
 }
 
+Players::ActionResult Players::PostAction(const Token& token, model::Dog::Direction dir) const noexcept
+{
+    std::shared_lock lock(lock_);
+
+    auto it = token_to_player_.find(token);
+    if (it == token_to_player_.end()) {
+        return ActionResult::UnknownToken;
+    }
+
+    return it->second->PostAction(dir) ? ActionResult::Posted : ActionResult::QueueFull;
+}
+
 Players::Pairs Players::GetPairs() const {
 
+    std::shared_lock lock(lock_);
+
     Pairs pairs;
 
     for (const auto& pair : token_to_player_) {
@@ -145,5 +180,20 @@ Players::Pairs Players::GetPairs() const {
     return pairs;
 }
 
+Players::Pairs Players::GetPairs(const model::GameSession& session) const {
+
+    std::shared_lock lock(lock_);
+
+    Pairs pairs;
+
+    for (const auto& pair : token_to_player_) {
+        if (&pair.second->GetSession() == &session) {
+            pairs.emplace_back(std::make_pair(pair.first, pair.second));
+        }
+    }
+
+    return pairs;
+}
+
 
 } // namespace app
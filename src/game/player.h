@@ -3,6 +3,8 @@
 #include <unordered_map>
 #include <vector>
 #include <list>
+#include <optional>
+#include <shared_mutex>
 
 #include "game_session.h"
 #include "model.h"
@@ -27,7 +29,11 @@ public:
     Player &operator=(Player &&) = default;
     Player(model::GameSession &session, Id id);
 
-    void ChangeDir(model::Dog::Direction dir) const noexcept;
+    //
+    //  команда собаке игрока - в очередь сессии, применится в ее strand
+    //  (см. GameSession::PostAction); если очередь полна - false
+    //
+    bool PostAction(model::Dog::Direction dir) const noexcept;
     void DismissDog();
 
     const std::string &GetName() const noexcept;
@@ -51,36 +57,64 @@ public:
     }
 
 private:
-    model::Dog* GetDog() const noexcept;
+    std::optional<model::DogRef> GetDog() const noexcept;
 
     model::GameSession *session_;
     Id id_;
+    //
+    //  устойчивая ссылка на собаку игрока - чтобы не искать
+    //  собаку по идентификатору на каждом запросе
+    //
+    model::SlotHandle dog_;
 };
 
 
+//
+//  Реестр игроков общий для всех сессий: игроки входят и выходят
+//  в strand своих сессий, поэтому реестр защищен своей блокировкой.
+//  Сам Player можно использовать только в strand его сессии
+//
 class Players {
 public:
     using Ptr = std::shared_ptr<Players>;
     using List = std::list<Player>;
     using Pairs = std::vector<std::pair<Token, const Player*>>;
 
+    enum class ActionResult {
+        Posted,
+        UnknownToken,
+        QueueFull
+    };
+
     Players() = default;
 
     void AddPlayer(Token token, model::GameSession& session, model::Dog::Id id);
     void AddPlayer(Token token, Player&& player);
     PlayerStatistics RemovePlayer(const Token& token);
-    Player *FindPlayer(const Token &token) const noexcept;
+
+    //
+    //  сессия игрока с токеном token; сессии живут, пока живет игра,
+    //  поэтому указатель можно использовать и после того, как игрок выйдет
+    //
+    const model::GameSession* FindSession(const Token &token) const noexcept;
+
+    //
+    //  Передать команду собаке игрока с токеном token. Игрок используется,
+    //  пока реестр заблокирован на чтение, и не может за это время выйти
+    //  из игры - поэтому вызывать можно из любого потока, не только
+    //  из strand сессии игрока
+    //
+    ActionResult PostAction(const Token& token, model::Dog::Direction dir) const noexcept;
     Pairs GetPairs() const;
-    const List& GetPlayers() const noexcept {
-        return players_;
-    }
+    Pairs GetPairs(const model::GameSession& session) const;
 
 private:
     using TokenToPlayer = std::unordered_map<Token, Player*, util::TaggedHasher<Token>>;
 
     Player *RemoveToken(const Token& token);
-    void RemovePlayer(Player::Id id);
+    void RemovePlayer(const Player* player);
 
+    mutable std::shared_mutex lock_;
     List players_;
     TokenToPlayer token_to_player_;
 };
@@ -34,7 +34,11 @@ std::optional<Token> ParseBearerToken(std::string_view bearer)
     // чтобы сделать их подбор ещё более затруднительным
     //
 
-    static PlayerTokens playerTokens;
+    //
+    //  вход в игру выполняется параллельно в strand-ах разных сессий,
+    //  поэтому генераторы у каждого потока свои
+    //
+    static thread_local PlayerTokens playerTokens;
 
     std::stringstream ss;
 
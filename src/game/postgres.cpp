@@ -40,6 +40,7 @@ void Database::PrepareQueries() {
 }
 
 void Database::SaveRecord(const app::PlayerStatistics& player) {
+    std::lock_guard lock(connection_lock_);
     pqxx::work work{connection_};
     work.exec_prepared(
         tag_insert_query_,
@@ -54,6 +55,8 @@ void Database::SaveRecord(const app::PlayerStatistics& player) {
 
 RecordsResult Database::GetRecords(int start, int max_count) {
 
+    std::lock_guard lock(connection_lock_);
+
     RecordsResult result;
     pqxx::read_transaction r(connection_);
 
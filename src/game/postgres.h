@@ -1,4 +1,5 @@
 #pragma once
+#include <mutex>
 #include <pqxx/pqxx>
 #include <pqxx/connection>
 #include <pqxx/transaction>
@@ -27,6 +28,10 @@ private:
     void CreateTablesIf();
     void PrepareQueries();
 
+    //
+    //  подключение одно, а обращаются к базе из strand разных сессий
+    //
+    std::mutex connection_lock_;
     pqxx::connection connection_;
     static constexpr auto tag_select_query_ = "select_query"_zv;
     static constexpr auto tag_insert_query_ = "insert_query"_zv;
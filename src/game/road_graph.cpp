@@ -0,0 +1,163 @@
+#include "../sdk.h"
+#include <algorithm>
+#include <tuple>
+
+#include "road_graph.h"
+
+namespace model {
+
+void RoadGraph::Build(const std::vector<Segment>& segments, double half_width) {
+
+    struct Corridor {
+        size_t order;
+        Segment segment;
+    };
+
+    //
+    //  Отрезки одной прямой идут подряд по возрастанию from, поэтому
+    //  слить их можно за один проход
+    //
+    std::vector<size_t> sorted(segments.size());
+    for (size_t idx = 0; idx < sorted.size(); ++idx) {
+        sorted[idx] = idx;
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [&segments](size_t lhs, size_t rhs) {
+        const auto& l = segments[lhs];
+        const auto& r = segments[rhs];
+        return std::tie(l.horizontal, l.line, l.from, lhs) < std::tie(r.horizontal, r.line, r.from, rhs);
+    });
+
+    std::vector<Corridor> corridors;
+
+    for (size_t idx : sorted) {
+        const auto& segment = segments[idx];
+
+        //
+        //  прямоугольники отрезков перекрываются или касаются - это один коридор
+        //
+        if (!corridors.empty()) {
+            auto& last = corridors.back();
+            if (last.segment.horizontal == segment.horizontal && last.segment.line == segment.line
+                && segment.from - half_width <= last.segment.to + half_width) {
+
+                last.segment.to = std::max(last.segment.to, segment.to);
+                last.order = std::min(last.order, idx);
+                continue;
+            }
+        }
+
+        corridors.push_back({idx, segment});
+    }
+
+    std::sort(corridors.begin(), corridors.end(), [](const Corridor& lhs, const Corridor& rhs) {
+        return lhs.order < rhs.order;
+    });
+
+    index_ = RoadIndex{};
+    horizontal_.clear();
+    parallel_.clear();
+
+    for (const auto& [order, segment] : corridors) {
+        if (segment.horizontal) {
+            index_.Add({segment.from - half_width, segment.line - half_width, segment.to + half_width, segment.line + half_width});
+        }
+        else {
+            index_.Add({segment.line - half_width, segment.from - half_width, segment.line + half_width, segment.to + half_width});
+        }
+        horizontal_.push_back(segment.horizontal);
+    }
+
+    //
+    //  коридоры, с которыми перекрывается параллельный коридор: на них
+    //  выбор между ними приходится делать и при движении вдоль коридора
+    //
+    parallel_.assign(Size(), false);
+    for (Index idx = 0; idx < Size(); ++idx) {
+        for (const auto& node : GetNodes(idx)) {
+            if (horizontal_[node.other] == horizontal_[idx]) {
+                parallel_[idx] = true;
+                break;
+            }
+        }
+    }
+
+    built_ = true;
+}
+
+RoadGraph::Index RoadGraph::Locate(Index hint, const geom::Point2D& pt, bool horizontal_move) const noexcept {
+
+    if (hint >= Size() || !GetRect(hint).Test(pt)) {
+        return FindAnywhere(pt, horizontal_move);
+    }
+
+    //
+    //  движение вдоль коридора, с которым не перекрывается ни один
+    //  параллельный, - дальше можно не искать
+    //
+    if (horizontal_[hint] == horizontal_move && !parallel_[hint]) {
+        return hint;
+    }
+
+    return FindCrossing(hint, pt, horizontal_move);
+}
+
+//
+//  Все коридоры, в которые попадает точка pt коридора idx, - среди его узлов,
+//  поэтому правило FindAnywhere можно применить к ним, не обращаясь к сетке:
+//  первый по порядку коридор нужного направления, иначе - последний из
+//  остальных (idx среди них, если он сам не нужного направления)
+//
+RoadGraph::Index RoadGraph::FindCrossing(Index idx, const geom::Point2D& pt, bool horizontal_move) const noexcept {
+
+    Index matching = horizontal_[idx] == horizontal_move ? idx : NO_CORRIDOR;
+    Index other = horizontal_[idx] == horizontal_move ? NO_CORRIDOR : idx;
+
+    const double v = index_.GetAxisCoord(idx, pt);
+    const auto& nodes = GetNodes(idx);
+
+    auto last = std::upper_bound(nodes.begin(), nodes.end(), v,
+        [](double value, const RoadIndex::Crossing& node) {
+            return value < node.from;
+        });
+
+    for (auto it = nodes.begin(); it != last; ++it) {
+        if (it->to < v || !GetRect(it->other).Test(pt)) {
+            continue;
+        }
+        if (horizontal_[it->other] == horizontal_move) {
+            matching = std::min(matching, it->other);
+        }
+        else if (other == NO_CORRIDOR || other < it->other) {
+            other = it->other;
+        }
+    }
+
+    return matching != NO_CORRIDOR ? matching : other;
+}
+
+//
+//  Собака еще не привязана к коридору (только что появилась или
+//  восстановлена из файла) - ищу через сетку индекса. Кандидаты идут
+//  в порядке коридоров, а выбор тот же, что и при поиске по списку дорог:
+//  первый коридор нужного направления, а если такого нет - последний
+//  из найденных
+//
+RoadGraph::Index RoadGraph::FindAnywhere(const geom::Point2D& pt, bool horizontal_move) const noexcept {
+
+    Index found = NO_CORRIDOR;
+
+    for (Index idx : index_.FindCandidates(pt)) {
+        if (!GetRect(idx).Test(pt)) {
+            continue;
+        }
+        if (horizontal_[idx] == horizontal_move) {
+            return idx;
+        }
+        found = idx;
+    }
+
+    return found;
+}
+
+} // namespace model
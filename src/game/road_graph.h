@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+
+#include "geom.h"
+#include "road_index.h"
+
+namespace model {
+
+//
+//  Граф дорог карты, который строится один раз после загрузки всех дорог.
+//  Дороги на одной прямой, которые перекрываются или касаются друг друга,
+//  сливаются в один коридор с общим прямоугольником - по коридору собака
+//  проходит за один шаг, не спотыкаясь о стыки отрезков. Места, где коридоры
+//  пересекаются (перекрестки, T-образные примыкания), - узлы графа: для
+//  каждого коридора они хранятся упорядоченными вдоль его оси, поэтому
+//  при повороте соседний коридор находится без поиска по всей карте.
+//
+class RoadGraph {
+public:
+    using Index = RoadIndex::Index;
+    using Nodes = RoadIndex::Crossings;
+
+    static constexpr Index NO_CORRIDOR = RoadIndex::NO_ROAD;
+
+    //
+    //  отрезок дороги: line - координата поперек дороги,
+    //  [from, to] - вдоль дороги (from <= to)
+    //
+    struct Segment {
+        bool horizontal;
+        double line;
+        double from;
+        double to;
+    };
+
+    //
+    //  half_width - половина ширины дороги, segments - в порядке дорог на карте;
+    //  коридоры нумеруются в порядке первой входящей в них дороги
+    //
+    void Build(const std::vector<Segment>& segments, double half_width);
+
+    bool IsBuilt() const noexcept {
+        return built_;
+    }
+
+    size_t Size() const noexcept {
+        return index_.Size();
+    }
+
+    const geom::Rect2D& GetRect(Index idx) const noexcept {
+        return index_.GetRect(idx);
+    }
+
+    bool IsHorizontal(Index idx) const noexcept {
+        return horizontal_[idx];
+    }
+
+    //
+    //  узлы коридора: участки вдоль его оси, где он пересекается с другими коридорами
+    //
+    const Nodes& GetNodes(Index idx) const noexcept {
+        return index_.GetCrossings(idx);
+    }
+
+    //
+    //  коридор, по которому движется собака в точке pt. hint - коридор,
+    //  найденный в прошлый раз: если точка на нем и собака движется вдоль
+    //  него, ответ известен сразу; при повороте следующий коридор ищется
+    //  среди узлов hint. Выбор тот же, что при поиске по всем дорогам карты:
+    //  первый по порядку коридор, направление которого совпадает с направлением
+    //  движения, а если такого нет - последний из содержащих точку
+    //
+    Index Locate(Index hint, const geom::Point2D& pt, bool horizontal_move) const noexcept;
+
+private:
+    Index FindCrossing(Index idx, const geom::Point2D& pt, bool horizontal_move) const noexcept;
+    Index FindAnywhere(const geom::Point2D& pt, bool horizontal_move) const noexcept;
+
+    RoadIndex index_;
+    std::vector<bool> horizontal_;
+    std::vector<bool> parallel_;
+    bool built_ = false;
+};
+
+} // namespace model
@@ -0,0 +1,113 @@
+#include "../sdk.h"
+#include <algorithm>
+#include <cmath>
+
+#include "road_index.h"
+
+namespace model {
+
+RoadIndex::Index RoadIndex::Add(const geom::Rect2D& rect) {
+
+    const Index idx = rects_.size();
+
+    rects_.push_back(rect);
+    crossings_.emplace_back();
+
+    const auto col_first = CellCoord(rect.left);
+    const auto col_last = CellCoord(rect.right);
+    const auto row_first = CellCoord(rect.top);
+    const auto row_last = CellCoord(rect.bottom);
+
+    //
+    //  Сначала собираю уже добавленные дороги из ячеек, которые накрывает
+    //  новая дорога - среди них все, с которыми она может пересечься
+    //
+    Indices neighbours;
+    for (auto row = row_first; row <= row_last; ++row) {
+        for (auto col = col_first; col <= col_last; ++col) {
+            if (auto it = cells_.find(MakeKey(col, row)); it != cells_.end()) {
+                neighbours.insert(neighbours.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+    for (Index other : neighbours) {
+        const auto& other_rect = rects_[other];
+
+        const geom::Rect2D overlap{
+            std::max(rect.left, other_rect.left),
+            std::max(rect.top, other_rect.top),
+            std::min(rect.right, other_rect.right),
+            std::min(rect.bottom, other_rect.bottom)
+        };
+
+        if (overlap.left > overlap.right || overlap.top > overlap.bottom) {
+            continue;
+        }
+
+        AddCrossing(idx, other, overlap);
+        AddCrossing(other, idx, overlap);
+    }
+
+    //
+    //  Индексы в ячейках получаются упорядоченными по возрастанию,
+    //  поскольку дороги добавляются по порядку
+    //
+    for (auto row = row_first; row <= row_last; ++row) {
+        for (auto col = col_first; col <= col_last; ++col) {
+            cells_[MakeKey(col, row)].push_back(idx);
+        }
+    }
+
+    return idx;
+}
+
+const RoadIndex::Indices& RoadIndex::FindCandidates(const geom::Point2D& pt) const noexcept {
+
+    static const Indices NO_CANDIDATES{};
+
+    if (auto it = cells_.find(MakeKey(CellCoord(pt.x), CellCoord(pt.y))); it != cells_.end()) {
+        return it->second;
+    }
+
+    return NO_CANDIDATES;
+}
+
+/*static*/ std::int32_t RoadIndex::CellCoord(double v) noexcept {
+    return static_cast<std::int32_t>(std::floor(v / CELL_SIZE));
+}
+
+/*static*/ RoadIndex::CellKey RoadIndex::MakeKey(std::int32_t col, std::int32_t row) noexcept {
+    return (static_cast<CellKey>(static_cast<std::uint32_t>(col)) << 32) | static_cast<std::uint32_t>(row);
+}
+
+//
+//  основная ось горизонтальной дороги - X, у вертикальной (и у дороги-точки) - Y
+//
+/*static*/ bool RoadIndex::IsAlongX(const geom::Rect2D& rect) noexcept {
+    return (rect.right - rect.left) > (rect.bottom - rect.top);
+}
+
+void RoadIndex::AddCrossing(Index idx, Index other, const geom::Rect2D& overlap) {
+
+    auto& crossings = crossings_[idx];
+
+    const Crossing crossing = IsAlongX(rects_[idx])
+        ? Crossing{overlap.left, overlap.right, other}
+        : Crossing{overlap.top, overlap.bottom, other};
+
+    //
+    //  Держу пересечения упорядоченными по началу участка, при равных
+    //  началах - в порядке добавления дорог
+    //
+    auto it = std::upper_bound(crossings.begin(), crossings.end(), crossing.from,
+        [](double value, const Crossing& c) {
+            return value < c.from;
+        });
+
+    crossings.insert(it, crossing);
+}
+
+} // namespace model
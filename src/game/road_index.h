@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "geom.h"
+
+namespace model {
+
+//
+//  Индекс прямоугольников дорог карты. Строится один раз при загрузке карты:
+//  прямоугольник каждой дороги вычисляется заранее и раскладывается по ячейкам
+//  равномерной сетки. Для каждой дороги еще запоминаются участки, на которых
+//  она пересекается с другими дорогами (перекрестки, наложения), вместе с
+//  дорогой, с которой она там пересекается.
+//
+class RoadIndex {
+public:
+    using Index = size_t;
+    using Indices = std::vector<Index>;
+
+    static constexpr Index NO_ROAD = std::numeric_limits<Index>::max();
+
+    //
+    //  участок [from, to] вдоль основной оси дороги, на котором ее
+    //  прямоугольник пересекается с прямоугольником дороги other
+    //
+    struct Crossing {
+        double from;
+        double to;
+        Index other;
+    };
+    using Crossings = std::vector<Crossing>;
+
+    //
+    //  добавить прямоугольник очередной дороги, индекс дороги равен
+    //  количеству уже добавленных дорог
+    //
+    Index Add(const geom::Rect2D& rect);
+
+    size_t Size() const noexcept {
+        return rects_.size();
+    }
+
+    const geom::Rect2D& GetRect(Index idx) const noexcept {
+        return rects_[idx];
+    }
+
+    //
+    //  дороги, которые могут содержать точку (индексы по возрастанию),
+    //  точку нужно еще проверить через Rect2D::Test
+    //
+    const Indices& FindCandidates(const geom::Point2D& pt) const noexcept;
+
+    //
+    //  пересечения дороги idx с другими дорогами по возрастанию from
+    //
+    const Crossings& GetCrossings(Index idx) const noexcept {
+        return crossings_[idx];
+    }
+
+    //
+    //  координата точки вдоль основной оси дороги idx
+    //
+    double GetAxisCoord(Index idx, const geom::Point2D& pt) const noexcept {
+        return IsAlongX(rects_[idx]) ? pt.x : pt.y;
+    }
+
+private:
+    using CellKey = std::uint64_t;
+
+    static constexpr double CELL_SIZE = 10.0;
+
+    static std::int32_t CellCoord(double v) noexcept;
+    static CellKey MakeKey(std::int32_t col, std::int32_t row) noexcept;
+    static bool IsAlongX(const geom::Rect2D& rect) noexcept;
+
+    void AddCrossing(Index idx, Index other, const geom::Rect2D& overlap);
+
+    std::vector<geom::Rect2D> rects_;
+    std::vector<Crossings> crossings_;
+    std::unordered_map<CellKey, Indices> cells_;
+};
+
+} // namespace model
@@ -0,0 +1,230 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace model {
+
+//
+//  Устойчивая ссылка на объект в хранилище. В отличие от номера слота
+//  не меняется, когда соседние объекты удаляются; после удаления самого
+//  объекта ссылка становится недействительной (поколение не совпадет)
+//
+struct SlotHandle {
+    static constexpr std::uint32_t NO_ENTRY = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t entry = NO_ENTRY;
+    std::uint32_t generation = 0;
+
+    [[nodiscard]] bool operator==(const SlotHandle&) const = default;
+};
+
+//
+//  Generational slot map - отображение идентификаторов и устойчивых ссылок
+//  на плотные слоты хранилища. Сами данные лежат в хранилище подряд, без дыр;
+//  при удалении на место удаленного объекта переносится последний (swap-remove),
+//  а здесь обновляется только его запись. Поиск и удаление за O(1).
+//
+//  Идентификаторы ищутся в собственной хеш-таблице с открытой адресацией:
+//  в отличие от std::unordered_map она не выделяет память на каждую вставку,
+//  а растет, только когда объектов становится больше, чем когда-либо было.
+//  Пока число объектов не растет, вставка и удаление обходятся без кучи
+//
+template <typename Id>
+class SlotMap {
+public:
+    size_t size() const noexcept {
+        return owners_.size();
+    }
+
+    //
+    //  добавить объект в конец хранилища, его слот равен size() до вставки
+    //
+    SlotHandle Insert(Id id) {
+
+        std::uint32_t entry = 0;
+
+        if (!free_.empty()) {
+            entry = free_.back();
+            free_.pop_back();
+        }
+        else {
+            entry = static_cast<std::uint32_t>(entries_.size());
+            entries_.push_back({});
+            //
+            //  в списке свободных записей заранее есть место под все записи -
+            //  тогда Erase никогда не выделяет память
+            //
+            free_.reserve(entries_.capacity());
+        }
+
+        InsertId(id, entry);
+        entries_[entry].slot = static_cast<std::uint32_t>(owners_.size());
+        owners_.push_back(entry);
+
+        return {entry, entries_[entry].generation};
+    }
+
+    std::optional<size_t> Find(Id id) const noexcept {
+
+        if (auto pos = FindId(id)) {
+            return entries_[ids_[*pos].entry].slot;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<size_t> Find(SlotHandle handle) const noexcept {
+
+        if (handle.entry < entries_.size() && entries_[handle.entry].generation == handle.generation) {
+            return entries_[handle.entry].slot;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<SlotHandle> FindHandle(Id id) const noexcept {
+
+        if (auto pos = FindId(id)) {
+            const std::uint32_t entry = ids_[*pos].entry;
+            return SlotHandle{entry, entries_[entry].generation};
+        }
+
+        return std::nullopt;
+    }
+
+    //
+    //  освободить слот: хранилище переносит последний объект на место slot,
+    //  id - идентификатор удаляемого объекта
+    //
+    void Erase(Id id, size_t slot) {
+
+        const std::uint32_t entry = owners_[slot];
+        const std::uint32_t moved = owners_.back();
+
+        owners_[slot] = moved;
+        entries_[moved].slot = static_cast<std::uint32_t>(slot);
+        owners_.pop_back();
+
+        //
+        //  новое поколение делает недействительными все старые ссылки на запись
+        //
+        ++entries_[entry].generation;
+        free_.push_back(entry);
+        EraseId(id);
+    }
+
+private:
+    struct Entry {
+        std::uint32_t slot = 0;
+        std::uint32_t generation = 0;
+    };
+
+    //
+    //  ячейка таблицы идентификаторов; пустая - entry == NO_ENTRY
+    //
+    struct IdCell {
+        Id id{};
+        std::uint32_t entry = SlotHandle::NO_ENTRY;
+    };
+
+    //
+    //  Идентификаторы выдаются подряд, поэтому мультипликативный хеш
+    //  (Фибоначчи) разбрасывает их по таблице равномерно
+    //
+    size_t HomeOf(Id id) const noexcept {
+        return static_cast<size_t>((static_cast<std::uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> 32) & (ids_.size() - 1);
+    }
+
+    std::optional<size_t> FindId(Id id) const noexcept {
+
+        if (ids_.empty()) {
+            return std::nullopt;
+        }
+
+        for (size_t pos = HomeOf(id); ids_[pos].entry != SlotHandle::NO_ENTRY; pos = (pos + 1) & (ids_.size() - 1)) {
+            if (ids_[pos].id == id) {
+                return pos;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void InsertId(Id id, std::uint32_t entry) {
+
+        //
+        //  таблица заполнена не больше чем наполовину - цепочки короткие
+        //
+        if (2 * (owners_.size() + 1) > ids_.size()) {
+            Rehash(ids_.empty() ? 16 : 2 * ids_.size());
+        }
+
+        size_t pos = HomeOf(id);
+        while (ids_[pos].entry != SlotHandle::NO_ENTRY) {
+            pos = (pos + 1) & (ids_.size() - 1);
+        }
+        ids_[pos] = {id, entry};
+    }
+
+    //
+    //  удаление без "надгробий": следующие за ячейкой элементы цепочки
+    //  сдвигаются назад, поэтому таблица не засоряется и не перестраивается
+    //
+    void EraseId(Id id) {
+
+        auto found = FindId(id);
+        if (!found) {
+            return;
+        }
+
+        const size_t mask = ids_.size() - 1;
+        size_t hole = *found;
+
+        for (size_t pos = (hole + 1) & mask; ids_[pos].entry != SlotHandle::NO_ENTRY; pos = (pos + 1) & mask) {
+            //
+            //  элемент можно перенести в дыру, если его домашняя ячейка
+            //  не лежит в цепочке между дырой и его текущим местом
+            //
+            const size_t home = HomeOf(ids_[pos].id);
+            if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+                ids_[hole] = ids_[pos];
+                hole = pos;
+            }
+        }
+
+        ids_[hole] = IdCell{};
+    }
+
+    void Rehash(size_t capacity) {
+
+        std::vector<IdCell> old(capacity);
+        std::swap(old, ids_);
+
+        for (const auto& cell : old) {
+            if (cell.entry == SlotHandle::NO_ENTRY) {
+                continue;
+            }
+            size_t pos = HomeOf(cell.id);
+            while (ids_[pos].entry != SlotHandle::NO_ENTRY) {
+                pos = (pos + 1) & (ids_.size() - 1);
+            }
+            ids_[pos] = cell;
+        }
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> free_;
+    //
+    //  запись, которой принадлежит каждый слот хранилища
+    //
+    std::vector<std::uint32_t> owners_;
+    //
+    //  хеш-таблица "идентификатор -> запись", размер - степень двойки
+    //
+    std::vector<IdCell> ids_;
+};
+
+} // namespace model
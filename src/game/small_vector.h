@@ -0,0 +1,169 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+namespace util {
+
+//
+//  Вектор с встроенным буфером на N элементов: пока элементов не больше N,
+//  они лежат прямо в объекте и память из кучи не выделяется, а копирование -
+//  это копирование нескольких байт. Если элементов больше, все они переезжают
+//  в кучу, как у обычного std::vector. Рассчитан на простые типы
+//  (trivially copyable) - элементы копируются без конструкторов.
+//
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>,
+                  "SmallVector holds trivially copyable types only");
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t INLINE_CAPACITY = N;
+
+    SmallVector() noexcept = default;
+
+    SmallVector(std::initializer_list<T> items) {
+        assign(items.begin(), items.end());
+    }
+
+    template <typename InputIt>
+    SmallVector(InputIt first, InputIt last) {
+        assign(first, last);
+    }
+
+    SmallVector(const SmallVector& other) {
+        assign(other.begin(), other.end());
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector(SmallVector&& other) noexcept {
+        Steal(other);
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            heap_.reset();
+            capacity_ = N;
+            Steal(other);
+        }
+        return *this;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        size_ = 0;
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    void push_back(const T& item) {
+        if (size_ == capacity_) {
+            Grow(std::max<size_t>(capacity_ * 2, 1));
+        }
+        data()[size_++] = item;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            Grow(capacity);
+        }
+    }
+
+    //
+    //  память не освобождается - мешок, опустевший на базе, снова наполнится
+    //
+    void clear() noexcept {
+        size_ = 0;
+    }
+
+    T* data() noexcept {
+        return heap_ ? heap_.get() : inline_.data();
+    }
+
+    const T* data() const noexcept {
+        return heap_ ? heap_.get() : inline_.data();
+    }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t idx) noexcept {
+        return data()[idx];
+    }
+
+    const T& operator[](size_t idx) const noexcept {
+        return data()[idx];
+    }
+
+    iterator begin() noexcept {
+        return data();
+    }
+
+    iterator end() noexcept {
+        return data() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return data();
+    }
+
+    const_iterator end() const noexcept {
+        return data() + size_;
+    }
+
+    [[nodiscard]] bool operator==(const SmallVector& other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+
+private:
+    void Grow(size_t capacity) {
+        auto heap = std::make_unique<T[]>(capacity);
+        std::copy(begin(), end(), heap.get());
+        heap_ = std::move(heap);
+        capacity_ = capacity;
+    }
+
+    void Steal(SmallVector& other) noexcept {
+        size_ = other.size_;
+        if (other.heap_) {
+            heap_ = std::move(other.heap_);
+            capacity_ = other.capacity_;
+        }
+        else {
+            std::copy(other.inline_.begin(), other.inline_.begin() + other.size_, inline_.begin());
+        }
+        other.size_ = 0;
+        other.capacity_ = N;
+    }
+
+    std::array<T, N> inline_{};
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    std::unique_ptr<T[]> heap_;
+};
+
+} // namespace util
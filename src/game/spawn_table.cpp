@@ -0,0 +1,82 @@
+#include "../sdk.h"
+#include <numeric>
+
+#include "spawn_table.h"
+
+namespace model {
+
+void SpawnTable::Build(const std::vector<double>& weights) {
+
+    const size_t count = weights.size();
+
+    columns_.assign(count, Column{1.0, 0});
+    if (count == 0) {
+        return;
+    }
+
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    //
+    //  вероятность каждой дороги, умноженная на их количество:
+    //  столбцы с долей меньше единицы добираются из столбцов с долей больше
+    //
+    std::vector<double> scaled(count, 1.0);
+    if (total > 0.0) {
+        for (size_t i = 0; i < count; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(count) / total;
+        }
+    }
+
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < count; ++i) {
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const size_t less = small.back();
+        small.pop_back();
+        const size_t more = large.back();
+
+        columns_[less] = {scaled[less], more};
+
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    //
+    //  то, что осталось, из-за погрешностей округления может быть
+    //  чуть меньше или больше единицы - такие столбцы заполнены целиком
+    //
+    for (size_t i : small) {
+        columns_[i] = {1.0, i};
+    }
+    for (size_t i : large) {
+        columns_[i] = {1.0, i};
+    }
+}
+
+SpawnTable::Sample SpawnTable::Draw(std::uint64_t bits) const noexcept {
+
+    static constexpr double TO_UNIT = 1.0 / 4294967296.0;
+
+    //
+    //  номер столбца без деления: (hi * count) >> 32 лежит в [0, count)
+    //
+    const auto hi = bits >> 32;
+    const auto column = static_cast<size_t>((hi * columns_.size()) >> 32);
+    const double fraction = static_cast<double>(bits & 0xFFFFFFFFull) * TO_UNIT;
+
+    const auto& [threshold, alias] = columns_[column];
+
+    if (fraction < threshold) {
+        return {column, fraction / threshold};
+    }
+
+    return {alias, (fraction - threshold) / (1.0 - threshold)};
+}
+
+} // namespace model
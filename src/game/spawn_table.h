@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace model {
+
+//
+//  Таблица псевдонимов (alias method, Walker/Vose) для выбора дороги, на
+//  которой появится собака или предмет. Вероятность выбрать дорогу
+//  пропорциональна ее длине, поэтому точки распределены по карте
+//  равномерно, а не сгущаются на коротких дорогах. Строится один раз
+//  при загрузке карты, выбор - за O(1) по одному случайному числу.
+//
+class SpawnTable {
+public:
+    //
+    //  выбранная дорога и положение на ней: offset в диапазоне [0, 1)
+    //
+    struct Sample {
+        size_t index;
+        double offset;
+    };
+
+    //
+    //  weights - длины дорог в порядке дорог на карте; если все они
+    //  нулевые (карта из одних точек), дороги выбираются равновероятно
+    //
+    void Build(const std::vector<double>& weights);
+
+    bool IsEmpty() const noexcept {
+        return columns_.empty();
+    }
+
+    //
+    //  bits - 64 случайных бита: старшая половина выбирает столбец таблицы,
+    //  младшая - между столбцом и его псевдонимом, а остаток от этого выбора
+    //  задает положение на дороге. Таблица не должна быть пустой
+    //
+    Sample Draw(std::uint64_t bits) const noexcept;
+
+private:
+    struct Column {
+        double threshold;
+        size_t alias;
+    };
+
+    std::vector<Column> columns_;
+};
+
+} // namespace model
@@ -1,4 +1,5 @@
 #include "../sdk.h"
+#include <algorithm>
 #include <boost/asio/bind_executor.hpp>
 
 #include "ticker.h"
@@ -7,24 +8,49 @@ namespace model {
 
 using namespace std::literals;
 
-Ticker::Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
+Ticker::Ticker(Strand strand, std::chrono::milliseconds period, Handler handler, TickerSettings settings)
 : strand_(strand)
 , period_(period)
-, handler_(handler) {
+, handler_(handler)
+, settings_(settings) {
 
+    settings_.max_steps = std::max<std::uint32_t>(settings_.max_steps, 1);
+}
+
+void Ticker::SetOverloadHandler(OverloadHandler handler) {
+    overload_handler_ = std::move(handler);
 }
 
 void Ticker::Start() {
-    last_tick_ = std::chrono::steady_clock::now();
 
     // Выполнить SchedulTick внутри strand_
-    net::post(strand_, [self = this->shared_from_this()]
-                  { self->ScheduleTick(); });
+    net::post(strand_, [self = this->shared_from_this()] {
+        self->deadline_ = Clock::now() + self->period_;
+        self->ScheduleTick();
+    });
+}
+
+Ticker::Stats Ticker::GetStats() const noexcept {
+
+    Stats stats;
+
+    stats.period = period_;
+    stats.ticks = ticks_.load(std::memory_order_relaxed);
+    stats.missed_deadlines = missed_deadlines_.load(std::memory_order_relaxed);
+    stats.shed_periods = shed_periods_.load(std::memory_order_relaxed);
+    stats.max_duration = std::chrono::microseconds(max_duration_us_.load(std::memory_order_relaxed));
+
+    for (size_t i = 0; i < DURATION_BUCKETS; ++i) {
+        stats.durations[i] = durations_[i].load(std::memory_order_relaxed);
+        stats.lateness[i] = lateness_[i].load(std::memory_order_relaxed);
+    }
+
+    return stats;
 }
 
 void Ticker::ScheduleTick() {
-    // выполнить OnTick через промежуток времени period_
-    timer_.expires_after(period_);
+    // выполнить OnTick к очередному сроку
+    timer_.expires_at(deadline_);
     timer_.async_wait(boost::asio::bind_executor(strand_, [self = this->shared_from_this()](sys::error_code ec) {
         self->OnTick(ec);}));
 }
@@ -36,11 +62,81 @@ void Ticker::OnTick(sys::error_code ec) {
         return;
     }
 
-    auto current_tick = std::chrono::steady_clock::now();
-    handler_(std::chrono::duration_cast<std::chrono::milliseconds>(current_tick - last_tick_));
-    last_tick_ = current_tick;
+    //
+    //  Сколько сроков наступило к моменту пробуждения: обычно один,
+    //  а если предыдущие тики затянулись - больше
+    //
+    const auto lateness = Clock::now() - deadline_;
+    const std::uint64_t due = 1 + static_cast<std::uint64_t>(lateness / period_);
+
+    lateness_[BucketOf(lateness)].fetch_add(1, std::memory_order_relaxed);
+
+    std::uint64_t steps = 1;
+    std::chrono::milliseconds delta = period_;
+
+    switch (settings_.policy) {
+    case OverloadPolicy::CatchUp:
+        delta = period_ * due;
+        break;
+    case OverloadPolicy::MultiStep:
+        steps = std::min<std::uint64_t>(due, settings_.max_steps);
+        break;
+    case OverloadPolicy::Shed:
+        break;
+    }
+
+    for (std::uint64_t i = 0; i < steps; ++i) {
+        RunHandler(delta);
+    }
+
+    //
+    //  Следующий срок - через период после последнего наступившего,
+    //  дробная часть опоздания не теряется
+    //
+    deadline_ += period_ * due;
+
+    if (due > 1) {
+        const std::uint64_t shed = (settings_.policy == OverloadPolicy::CatchUp) ? 0 : due - steps;
+
+        missed_deadlines_.fetch_add(due - 1, std::memory_order_relaxed);
+        shed_periods_.fetch_add(shed, std::memory_order_relaxed);
+
+        if (overload_handler_) {
+            overload_handler_(Overload{due - 1, shed, lateness});
+        }
+    }
+
     ScheduleTick();
 }
 
+void Ticker::RunHandler(std::chrono::milliseconds delta) {
+
+    const auto started = Clock::now();
+    handler_(delta);
+    const auto duration = Clock::now() - started;
+
+    durations_[BucketOf(duration)].fetch_add(1, std::memory_order_relaxed);
+
+    const auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    if (duration_us > max_duration_us_.load(std::memory_order_relaxed)) {
+        max_duration_us_.store(duration_us, std::memory_order_relaxed);
+    }
+
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+//
+//  корзина по долям периода: 1/8 -> 0, 1/4 -> 1, 1/2 -> 2, 1 -> 3, 2 -> 4, дольше -> 5
+//
+size_t Ticker::BucketOf(Clock::duration duration) const noexcept {
+
+    size_t bucket = 0;
+    for (auto bound = period_ / 8.0; bucket + 1 < DURATION_BUCKETS && duration >= bound; bound *= 2) {
+        ++bucket;
+    }
+
+    return bucket;
+}
+
 
 } // namespace model
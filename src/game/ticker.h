@@ -1,6 +1,10 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <memory>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/asio/steady_timer.hpp>
@@ -11,27 +15,100 @@ namespace model {
 namespace net = boost::asio;
 namespace sys = boost::system;
 
+//
+//  Что делать, если тик проснулся позже, чем через период - например,
+//  предыдущий тик обрабатывался дольше периода:
+//      CatchUp   - один тик с дельтой за все прошедшие периоды;
+//      MultiStep - несколько тиков по одному периоду, но не больше max_steps,
+//                  остальные периоды отбрасываются;
+//      Shed      - один тик на период, пропущенные периоды отбрасываются
+//                  (игровое время отстает от реального, зато тик не растет)
+//
+enum class OverloadPolicy {
+    CatchUp,
+    MultiStep,
+    Shed
+};
+
+struct TickerSettings {
+    OverloadPolicy policy = OverloadPolicy::CatchUp;
+    std::uint32_t max_steps = 4;
+};
 
 class Ticker : public std::enable_shared_from_this<Ticker> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
+    using Clock = std::chrono::steady_clock;
     using Handler = std::function<void(std::chrono::milliseconds delta)>;
     using Ptr = std::shared_ptr<Ticker>;
 
-    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler);
+    //
+    //  Корзины распределения длительности тика и опоздания таймера в долях
+    //  периода: до 1/8, до 1/4, до 1/2, до 1, до 2 периодов и дольше
+    //
+    static constexpr size_t DURATION_BUCKETS = 6;
+
+    struct Stats {
+        std::chrono::milliseconds period{};
+        std::uint64_t ticks = 0;             // вызовов обработчика
+        std::uint64_t missed_deadlines = 0;  // сроков, к которым тик не успел
+        std::uint64_t shed_periods = 0;      // отброшенных периодов игрового времени
+        std::chrono::microseconds max_duration{};
+        std::array<std::uint64_t, DURATION_BUCKETS> durations{};
+        std::array<std::uint64_t, DURATION_BUCKETS> lateness{};
+    };
+
+    //
+    //  Сведения об одном опоздании - передаются обработчику перегрузки
+    //
+    struct Overload {
+        std::uint64_t missed_deadlines = 0;
+        std::uint64_t shed_periods = 0;
+        Clock::duration lateness{};
+    };
+
+    using OverloadHandler = std::function<void(const Overload& overload)>;
+
+    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler, TickerSettings settings = {});
+
+    //
+    //  Вызывается в strand таймера при каждом опоздании; задается до Start
+    //
+    void SetOverloadHandler(OverloadHandler handler);
 
     void Start();
 
+    //
+    //  Счетчики можно читать из любого потока
+    //
+    [[nodiscard]] Stats GetStats() const noexcept;
+
 private:
     void ScheduleTick();
     void OnTick(sys::error_code ec);
+    void RunHandler(std::chrono::milliseconds delta);
+    size_t BucketOf(Clock::duration duration) const noexcept;
 
 private:
     Strand strand_;
     net::steady_timer timer_{strand_};
     std::chrono::milliseconds period_;
     Handler handler_;
-    std::chrono::steady_clock::time_point last_tick_;
+    TickerSettings settings_;
+    OverloadHandler overload_handler_;
+
+    //
+    //  Тики назначаются на абсолютные сроки start + N * period, поэтому время
+    //  обработки тика не сдвигает следующие тики
+    //
+    Clock::time_point deadline_;
+
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> missed_deadlines_{0};
+    std::atomic<std::uint64_t> shed_periods_{0};
+    std::atomic<std::int64_t> max_duration_us_{0};
+    std::array<std::atomic<std::uint64_t>, DURATION_BUCKETS> durations_{};
+    std::array<std::atomic<std::uint64_t>, DURATION_BUCKETS> lateness_{};
 }; 
 
 
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace util {
+
+//
+//  Генератор xoshiro256** (Blackman, Vigna). Состояние - четыре 64-битных
+//  слова, шаг - несколько сдвигов и умножений, поэтому он заметно быстрее
+//  std::mt19937_64 и занимает 32 байта вместо 2.5 КБ. Удовлетворяет
+//  UniformRandomBitGenerator, так что подходит для std::*_distribution.
+//  При одинаковом зерне выдает одинаковую последовательность на любой платформе
+//
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    static constexpr result_type default_seed = 5489u;
+
+    explicit Xoshiro256(result_type seed = default_seed) noexcept {
+        Seed(seed);
+    }
+
+    //
+    //  состояние заполняется из зерна генератором splitmix64 - так
+    //  даже близкие зерна дают непохожие последовательности
+    //
+    void Seed(result_type seed) noexcept {
+        for (auto& word : state_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            result_type z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        const result_type result = Rotl(state_[1] * 5, 7) * 9;
+        const result_type t = state_[1] << 17;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+
+        state_[2] ^= t;
+        state_[3] = Rotl(state_[3], 45);
+
+        return result;
+    }
+
+    bool operator==(const Xoshiro256&) const = default;
+
+private:
+    static constexpr result_type Rotl(result_type x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::array<result_type, 4> state_{};
+};
+
+} // namespace util
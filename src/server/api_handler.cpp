@@ -1,4 +1,6 @@
 #include "../sdk.h"
+#include <charconv>
+
 #include "json_serializer.h"
 #include "json_loader.h"
 #include "ci_string.h"
@@ -49,6 +51,18 @@ bool ApiHandlerBase::IsAuthorizationRequired() const noexcept {
     return is_authorization_required_;
 }
 
+std::optional<app::Application::Strand> ApiHandlerBase::SelectStrand(const StringRequest&) const {
+    return std::nullopt;
+}
+
+bool ApiHandlerBase::RunsInPlace() const noexcept {
+    return false;
+}
+
+std::optional<std::string> ApiHandlerBase::GetETag(const std::optional<app::Token>&) const {
+    return std::nullopt;
+}
+
 
 ApiRequestHandler::ApiRequestHandler(app::Application::Ptr application, bool enable_tick_requests)
 : app_(application) {
@@ -96,7 +110,7 @@ bool ApiRequestHandler::IsApiRequest(const StringRequest &req) {
     return req.target().starts_with(Endpoint::REST_API);
 }
 
-StringResponse ApiRequestHandler::HandleRequest(StringRequest &&req) {
+VariantResponse ApiRequestHandler::HandleRequest(StringRequest &&req) {
     //
     //  в зависимости от метода и пути запроса создаю нужный обработчик
     //
@@ -151,7 +165,30 @@ StringResponse ApiRequestHandler::HandleRequest(StringRequest &&req) {
     //  но обработчик тоже кидается исключениями если что-то пошло не так
     //
     try {
-        return apiOperation->HandleRequest(std::move(req), token);
+        //
+        //  Если у клиента уже есть текущая версия ответа - 304 без тела,
+        //  без сериализации и вообще без вызова обработчика
+        //
+        const auto etag = apiOperation->GetETag(token);
+        if (etag && MatchesETag(req[http::field::if_none_match], *etag)) {
+            return NotModifiedResponse(std::move(req), *etag);
+        }
+
+        auto response = apiOperation->HandleRequest(std::move(req), token);
+
+        //
+        //  ETag взят до обработки, поэтому ответ может оказаться новее его
+        //  (но не старше) - тогда следующий запрос просто получит ответ заново
+        //
+        if (etag) {
+            std::visit([&etag](auto& r) {
+                if (r.result() == http::status::ok) {
+                    r.set(http::field::etag, *etag);
+                }
+            }, response);
+        }
+
+        return response;
     }
     catch (const app::Error& e) {
         return JsonStringResponse(
@@ -168,6 +205,24 @@ StringResponse ApiRequestHandler::HandleRequest(StringRequest &&req) {
 
 }
 
+std::optional<app::Application::Strand> ApiRequestHandler::SelectStrand(const StringRequest &req) {
+
+    if (auto apiOperation = SelectApiHandler(req.target())) {
+        return apiOperation->SelectStrand(req);
+    }
+
+    return std::nullopt;
+}
+
+bool ApiRequestHandler::RunsInPlace(const StringRequest &req) {
+
+    if (auto apiOperation = SelectApiHandler(req.target())) {
+        return apiOperation->RunsInPlace();
+    }
+
+    return false;
+}
+
 ApiHandlerBase::Ptr ApiRequestHandler::SelectApiHandler(std::string_view target)
 {
     //
@@ -207,7 +262,7 @@ MapsHandler::MapsHandler(app::Application::Ptr application)
 {    
 }
 
-StringResponse MapsHandler::HandleRequest(StringRequest &&req, const std::optional<app::Token>&)
+VariantResponse MapsHandler::HandleRequest(StringRequest &&req, const std::optional<app::Token>&)
 {
     auto target = req.target();
 
@@ -252,7 +307,7 @@ GameJoin::GameJoin(app::Application::Ptr application)
 {
 }
 
-StringResponse GameJoin::HandleRequest(StringRequest &&req, const std::optional<app::Token>&) {
+VariantResponse GameJoin::HandleRequest(StringRequest &&req, const std::optional<app::Token>&) {
     //
     //  Распарсить тело запроса - получить имя и ид. карты
     //
@@ -281,6 +336,24 @@ StringResponse GameJoin::HandleRequest(StringRequest &&req, const std::optional<
 
 }
 
+std::optional<app::Application::Strand> GameJoin::SelectStrand(const StringRequest& req) const {
+
+    //
+    //  Выбор strand занимает место в сессии карты, поэтому здесь отсеиваю
+    //  запросы, до JoinGame которых дело не дойдет (место занимается только
+    //  тогда, когда JoinGame точно будет вызван и сам его освободит при ошибке)
+    //
+    if (!CheckRequestMethod(req.method()) || !CheckContentType(req[http::field::content_type])) {
+        return std::nullopt;
+    }
+
+    if (auto name_and_mapid = json_loader::ParseJoinRequest(req.body())) {
+        return app_->FindStrand(name_and_mapid->id);
+    }
+
+    return std::nullopt;
+}
+
 //
 //  Получение списка игроков
 //
@@ -289,7 +362,7 @@ GamePlayers::GamePlayers(app::Application::Ptr application)
 {
 }
 
-StringResponse GamePlayers::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
+VariantResponse GamePlayers::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
     //
     //  Получить список пользователей (внутри делается проверка что токен кому-то принадлежит)
     //
@@ -307,6 +380,15 @@ StringResponse GamePlayers::HandleRequest(StringRequest &&req, const std::option
 
 }
 
+bool GamePlayers::RunsInPlace() const noexcept {
+    return true;
+}
+
+std::optional<std::string> GamePlayers::GetETag(const std::optional<app::Token>& token) const {
+    const auto snapshot = app_->GetState(*token).snapshot;
+    return MakeETag(snapshot->epoch, snapshot->players_generation);
+}
+
 
 //
 //  Запрос игрового состояния
@@ -316,25 +398,93 @@ GameState::GameState(app::Application::Ptr application)
 {
 }
 
-StringResponse GameState::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
+VariantResponse GameState::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
+
+    //
+    //  Распарсить параметры запроса - с какого снимка нужны изменения (since)
+    //
+    std::optional<model::SessionSnapshot::Generation> since;
+    if (!ParseRequest(req.target(), since)) {
+        return JsonStringResponse(
+            std::move(req),
+            http::status::bad_request,
+            BAD_REQUEST);
+    }
 
     //
     //  Получить состояние (список собак с координатами и т.п.)
     //
-    auto states = app_->GetState(*token);
+    auto states = app_->GetState(*token, since);
+    const auto generation = std::to_string(states.snapshot->generation);
 
     //
-    //  Сериализовать результат
+    //  Изменения с запрошенного снимка сериализуются на каждый запрос -
+    //  у каждого игрока свой since
+    //
+    if (states.base) {
+        auto response = JsonStringResponse(
+            std::move(req),
+            http::status::ok,
+            json_serializer::SerializeStateDelta(*states.snapshot, *states.base));
+        response.set(GENERATION_HEADER, generation);
+        return response;
+    }
+
     //
-    auto responseBody = json_serializer::SerializeStateResult(states);
+    //  Полное состояние сериализуется один раз на снимок, все игроки сессии
+    //  до следующего тика получают ту же строку
+    //
+    auto responseBody = states.snapshot->GetStateBody(json_serializer::SerializeStateResult);
 
     //
     //  Вернуть ответ
     //
-    return JsonStringResponse(std::move(req), http::status::ok, responseBody);
+    auto response = JsonSharedResponse(std::move(req), http::status::ok, std::move(responseBody));
+    response.set(GENERATION_HEADER, generation);
+    return response;
 
 }
 
+//
+//  единственный параметр - since=<номер снимка>; false, если он есть, но это не число
+//
+bool GameState::ParseRequest(std::string_view target, std::optional<model::SessionSnapshot::Generation>& since) {
+
+    auto stop = target.find('?');
+    if (stop == std::string_view::npos) {
+        return true;
+    }
+
+    std::vector<std::string> tags;
+    boost::algorithm::split(tags, target.substr(stop + 1), boost::algorithm::is_any_of("&="), boost::algorithm::token_compress_off);
+
+    for (size_t i = 0; i + 1 < tags.size(); i += 2) {
+        if (tags[i] != P_SINCE) {
+            continue;
+        }
+
+        const auto& value = tags[i + 1];
+        model::SessionSnapshot::Generation generation = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), generation);
+        if (ec != std::errc{} || ptr != value.data() + value.size()) {
+            return false;
+        }
+
+        since = generation;
+    }
+
+    return true;
+}
+
+bool GameState::RunsInPlace() const noexcept {
+    return true;
+}
+
+std::optional<std::string> GameState::GetETag(const std::optional<app::Token>& token) const {
+    const auto snapshot = app_->GetState(*token).snapshot;
+    return MakeETag(snapshot->epoch, snapshot->generation);
+}
+
 //
 //  Управление действиями своего персонажа
 //
@@ -343,7 +493,7 @@ GameAction::GameAction(app::Application::Ptr application)
 {
 }
 
-StringResponse GameAction::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
+VariantResponse GameAction::HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) {
     //
     //  Распарсить тело запроса - получить направление движения
     //
@@ -369,6 +519,10 @@ StringResponse GameAction::HandleRequest(StringRequest &&req, const std::optiona
     
 }
 
+bool GameAction::RunsInPlace() const noexcept {
+    return true;
+}
+
 
 //
 //  Запрос для управления временем на карте
@@ -378,7 +532,7 @@ GameTick::GameTick(app::Application::Ptr application)
 {
 }
 
-StringResponse GameTick::HandleRequest(StringRequest &&req, const std::optional<app::Token>&)
+VariantResponse GameTick::HandleRequest(StringRequest &&req, const std::optional<app::Token>&)
 {
     //
     //  Распарсить тело запроса - получить дельту времени
@@ -470,7 +624,7 @@ RecordsHandler::Parameters RecordsHandler::ParseRequest(std::string_view target)
     return params;
 }
 
-StringResponse RecordsHandler::HandleRequest(StringRequest &&req, const std::optional<app::Token>&) {
+VariantResponse RecordsHandler::HandleRequest(StringRequest &&req, const std::optional<app::Token>&) {
     
     //
     //  Распарсить параметры запроса - получить start и maxItems
@@ -46,7 +46,7 @@ public:
     //  ответ помещается в std::variant, который может хранить 
     //  либо строку, либо файл, либо..
     //
-    virtual StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) = 0;
+    virtual VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) = 0;
 
     //
     //  проверка поддерживаемых методов
@@ -68,6 +68,25 @@ public:
     //
     bool IsAuthorizationRequired() const noexcept;
 
+    //
+    //  в каком strand выполнять запрос: nullopt - в общем strand для API.
+    //  Запросы игроков с токеном выполняются сразу (см. RunsInPlace)
+    //
+    virtual std::optional<app::Application::Strand> SelectStrand(const StringRequest& req) const;
+
+    //
+    //  можно ли выполнить запрос сразу в потоке, который его принял,
+    //  без всякого strand (обработчик сам потокобезопасен)
+    //
+    virtual bool RunsInPlace() const noexcept;
+
+    //
+    //  ETag текущей версии ответа, если его можно узнать дешево - без
+    //  сериализации (nullopt - ответ без ETag). По нему запрос с совпавшим
+    //  If-None-Match получает 304 еще до вызова HandleRequest
+    //
+    virtual std::optional<std::string> GetETag(const std::optional<app::Token>& token) const;
+
 protected:
     //
     //  чтобы не было соблазнов создавать экземляры этого класса
@@ -117,7 +136,17 @@ class ApiRequestHandler {
 public:
     ApiRequestHandler(app::Application::Ptr application, bool enable_tick_requests);
 
-    StringResponse HandleRequest(StringRequest &&req);
+    VariantResponse HandleRequest(StringRequest &&req);
+
+    //
+    //  strand сессии, в которой нужно выполнить запрос (см. ApiHandlerBase::SelectStrand)
+    //
+    std::optional<app::Application::Strand> SelectStrand(const StringRequest &req);
+
+    //
+    //  выполнить запрос сразу, без strand (см. ApiHandlerBase::RunsInPlace)
+    //
+    bool RunsInPlace(const StringRequest &req);
 
     //  если URI-строка запроса начинается с /api/, ...
     static bool IsApiRequest(const StringRequest &req);
@@ -144,7 +173,7 @@ class MapsHandler : public ApiHandlerBase {
 public:
     explicit MapsHandler(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
 
 private:
     StringResponse HandleMapsList(StringRequest&& req);
@@ -158,7 +187,12 @@ class GameJoin : public ApiHandlerBase {
 public:
     explicit GameJoin(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
+
+    //
+    //  вход в игру выполняется в strand сессии карты, на которую входит игрок
+    //
+    std::optional<app::Application::Strand> SelectStrand(const StringRequest& req) const override;
 
 private:
     constexpr static std::string_view BAD_REQUEST = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Join game request parse error\"\n}"sv;
@@ -171,7 +205,17 @@ class GamePlayers : public ApiHandlerBase {
 public:
     explicit GamePlayers(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+
+    //
+    //  ответ берется из снимка сессии - strand сессии не нужен
+    //
+    bool RunsInPlace() const noexcept override;
+
+    //
+    //  номер снимка, в котором последний раз менялся список игроков
+    //
+    std::optional<std::string> GetETag(const std::optional<app::Token>& token) const override;
 
 };
 
@@ -182,8 +226,29 @@ class GameState : public ApiHandlerBase {
 public:
     explicit GameState(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+    //
+    //  С параметром since=<номер снимка> отдаются только изменения с этого
+    //  снимка, если он еще в истории сессии, иначе - полное состояние.
+    //  Номер отданного снимка - в заголовке X-State-Generation
+    //
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+
+    //
+    //  ответ берется из снимка сессии - strand сессии не нужен
+    //
+    bool RunsInPlace() const noexcept override;
+
+    //
+    //  номер последнего снимка сессии
+    //
+    std::optional<std::string> GetETag(const std::optional<app::Token>& token) const override;
 
+private:
+    static bool ParseRequest(std::string_view target, std::optional<model::SessionSnapshot::Generation>& since);
+
+    constexpr static std::string_view BAD_REQUEST = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Parameter since is invalid\"\n}"sv;
+    constexpr static std::string_view P_SINCE = "since"sv;
+    constexpr static std::string_view GENERATION_HEADER = "X-State-Generation"sv;
 };
 
 //
@@ -193,7 +258,12 @@ class GameAction : public ApiHandlerBase {
 public:
     explicit GameAction(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+
+    //
+    //  команда только кладется в очередь сессии - strand сессии не нужен
+    //
+    bool RunsInPlace() const noexcept override;
 
 private:
     constexpr static std::string_view BAD_REQUEST = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Failed to parse action JSON\"\n}"sv;
@@ -207,7 +277,7 @@ class GameTick : public ApiHandlerBase {
 public:
     explicit GameTick(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>& token) override;
 
 private:
     constexpr static std::string_view BAD_REQUEST = "{\n\"code\": \"invalidArgument\",\n\"message\": \"Failed to parse tick request JSON\"\n}"sv;
@@ -221,7 +291,7 @@ class RecordsHandler : public ApiHandlerBase {
 public:
     explicit RecordsHandler(app::Application::Ptr application);
 
-    StringResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
+    VariantResponse HandleRequest(StringRequest &&req, const std::optional<app::Token>&) override;
 
 private:
     struct Parameters {
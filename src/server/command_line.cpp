@@ -1,6 +1,10 @@
 #include "../sdk.h"
+#include <charconv>
 #include <iostream>
 #include <boost/program_options.hpp>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 #include "command_line.h"
 
@@ -8,6 +12,68 @@ namespace util {
 
 using namespace std::literals;
 
+namespace {
+
+//
+//  номера процессоров, к которым можно привязать поток (см. PinThread)
+//
+#ifdef __linux__
+constexpr unsigned MAX_CPUS = CPU_SETSIZE;
+#else
+constexpr unsigned MAX_CPUS = 1024;
+#endif
+
+} // namespace
+
+std::vector<unsigned> ParseCpuList(const std::string& list) {
+
+    namespace po = boost::program_options;
+
+    std::vector<unsigned> cpus;
+
+    //
+    //  пустые элементы (пустой список, лишняя запятая) - тоже ошибка
+    //
+    std::string_view rest = list;
+    for (bool more = true; more; ) {
+        const auto comma = rest.find(',');
+        const auto item = rest.substr(0, comma);
+        more = (comma != std::string_view::npos);
+        rest = more ? rest.substr(comma + 1) : std::string_view{};
+
+        const auto dash = item.find('-');
+        unsigned first = 0;
+        unsigned last = 0;
+
+        auto parse = [&list](std::string_view text, unsigned& value) {
+            const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (text.empty() || ec != std::errc{} || ptr != text.data() + text.size()) {
+                throw po::validation_error(po::validation_error::invalid_option_value, "tick-cpus"s, list);
+            }
+        };
+
+        parse(item.substr(0, dash), first);
+        last = first;
+        if (dash != std::string_view::npos) {
+            parse(item.substr(dash + 1), last);
+        }
+
+        //
+        //  номер за пределами набора процессоров отвергается сразу - иначе
+        //  диапазон вроде 0-4294967295 разворачивался бы в список бесконечно
+        //
+        if (last < first || last >= MAX_CPUS) {
+            throw po::validation_error(po::validation_error::invalid_option_value, "tick-cpus"s, list);
+        }
+
+        for (unsigned cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[])
 {
     namespace po = boost::program_options;
@@ -23,12 +89,27 @@ using namespace std::literals;
          "set static files root") //
         ("tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"s)->default_value(0, ""),
          "set tick period (optional)") //
+        ("tick-overload-policy", po::value(&args.tick_overload_policy)->value_name("policy"s)->default_value("catch-up"s)
+            ->notifier([](const std::string& policy) {
+                if (policy != "catch-up"s && policy != "multi-step"s && policy != "shed"s) {
+                    throw po::validation_error(po::validation_error::invalid_option_value, "tick-overload-policy"s, policy);
+                }
+            }),
+         "set overdue ticks policy: catch-up, multi-step or shed (optional)") //
+        ("tick-max-steps", po::value(&args.tick_max_steps)->value_name("count"s)->default_value(4),
+         "set max ticks per wake-up for multi-step policy (optional)") //
+        ("tick-thread", po::bool_switch(&args.tick_thread),
+         "run game timer on a dedicated thread (optional)") //
+        ("tick-cpus", po::value<std::string>()->value_name("list"s),
+         "pin dedicated timer thread to cpus, e.g. 2,3 or 2-5 (optional, implies --tick-thread)") //
         ("randomize-spawn-points", po::bool_switch(&args.randomize_spawn_points),
          "spawn dogs at random positions (optional)")
          ("state-file", po::value(&args.state_file)->value_name("file"s),
          "set save configuration file (optional)")
          ("save-state-period", po::value(&args.save_state_period)->value_name("milliseconds"s)->default_value(0, ""),
-         "set auto save configuration period (optional)"); //
+         "set auto save configuration period (optional)")
+         ("random-seed", po::value<std::uint64_t>()->value_name("seed"s),
+         "set random seed of game sessions (optional)"); //
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -46,6 +127,15 @@ using namespace std::literals;
     //
     po::notify(vm);
 
+    if (vm.contains("tick-cpus"s)) {
+        args.tick_cpus = ParseCpuList(vm["tick-cpus"s].as<std::string>());
+        args.tick_thread = true;
+    }
+
+    if (vm.contains("random-seed"s)) {
+        args.random_seed = vm["random-seed"s].as<std::uint64_t>();
+    }
+
     return args;
 }
 
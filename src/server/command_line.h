@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <optional>
+#include <cstdint>
+#include <vector>
 #include "../game/model_units.h"
 
 
@@ -26,6 +28,22 @@ struct Args {
     //
     std::int64_t tick_period;
 
+    //
+    //  Что делать, если тики не успевают к сроку: catch-up - один тик
+    //  за все пропущенное время, multi-step - несколько тиков по периоду
+    //  (не больше tick_max_steps), shed - пропущенное время отбрасывается
+    //
+    std::string tick_overload_policy;
+    std::uint32_t tick_max_steps;
+
+    //
+    //  Запускать таймер игры в отдельном потоке со своим io_context,
+    //  а не вместе с HTTP-запросами; если задан список процессоров -
+    //  поток привязывается к ним (список вида 2,3 или 2-5)
+    //
+    bool tick_thread;
+    std::vector<unsigned> tick_cpus;
+
     //
     //  Включает режим, при котором пёс игрока появляется
     //  в случайной точке случайно выбранной дороги карты
@@ -41,8 +59,20 @@ struct Args {
     //  Период автосохранения состояния в миллисекундах
     //
     std::int64_t save_state_period;
+
+    //
+    //  Зерно генераторов случайных чисел игровых сессий - с одним и тем же
+    //  зерном игра воспроизводится (например, для сравнения замеров)
+    //
+    std::optional<std::uint64_t> random_seed;
 };
 
+//
+//  Список процессоров вида "0,2-3,6" (параметр --tick-cpus); номера - меньше
+//  размера набора процессоров системы, при ошибке - boost::program_options::validation_error
+//
+std::vector<unsigned> ParseCpuList(const std::string& list);
+
 //
 //  Достать параметры сервера из командной строки
 //
@@ -55,6 +55,76 @@ StringResponse JsonStringResponse(
 
 }
 
+//
+// Ответ application/json (Cache-Control = no-cache) с общим телом body
+//
+SharedStringResponse JsonSharedResponse(
+    StringRequest &&req,
+    http::status status,
+    SharedStringBody::value_type body) {
+
+    SharedStringResponse response(status, req.version());
+
+    response.set(http::field::content_type, ContentType::APP_JSON);
+    response.set(http::field::cache_control, CacheControl::NO_CACHE);
+    response.content_length(SharedStringBody::size(body));
+    response.body() = std::move(body);
+    response.keep_alive(req.keep_alive());
+
+    return response;
+
+}
+
+StringResponse NotModifiedResponse(
+    StringRequest &&req,
+    std::string_view etag) {
+
+    //
+    //  у ответа 304 тела нет, поэтому и Content-Length не нужен
+    //
+    StringResponse response(http::status::not_modified, req.version());
+
+    response.set(http::field::etag, etag);
+    response.set(http::field::cache_control, CacheControl::NO_CACHE);
+    response.keep_alive(req.keep_alive());
+
+    return response;
+
+}
+
+std::string MakeETag(std::uint64_t epoch, std::uint64_t version) {
+    return "\"" + std::to_string(epoch) + "-" + std::to_string(version) + "\"";
+}
+
+bool MatchesETag(std::string_view if_none_match, std::string_view etag) {
+
+    while (!if_none_match.empty()) {
+        auto stop = if_none_match.find(',');
+        auto candidate = if_none_match.substr(0, stop);
+        if_none_match = (stop == std::string_view::npos) ? std::string_view{} : if_none_match.substr(stop + 1);
+
+        while (!candidate.empty() && candidate.front() == ' ') {
+            candidate.remove_prefix(1);
+        }
+        while (!candidate.empty() && candidate.back() == ' ') {
+            candidate.remove_suffix(1);
+        }
+
+        //
+        //  для If-None-Match слабое сравнение - префикс W/ не учитывается
+        //
+        if (candidate.starts_with("W/"sv)) {
+            candidate.remove_prefix(2);
+        }
+
+        if (candidate == "*"sv || candidate == etag) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 //
 //  обработчик любого запроса с "плохим" методом
 //
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <variant>
 
@@ -12,6 +14,8 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 
+#include "shared_string_body.h"
+
 namespace http_handler {
 
 namespace beast = boost::beast;
@@ -29,8 +33,10 @@ using StringRequest = http::request<http::string_body>;
 using StringResponse = http::response<http::string_body>;
 // Ответ, тело которого представлено в виде файла
 using FileResponse = http::response<http::file_body>;
+// Ответ, тело которого - строка, общая для многих ответов
+using SharedStringResponse = http::response<SharedStringBody>;
 // Сюда можно положить и строку и файл
-using VariantResponse = std::variant<StringResponse, FileResponse>;
+using VariantResponse = std::variant<StringResponse, FileResponse, SharedStringResponse>;
 
 struct CacheControl {
     CacheControl() = delete;
@@ -84,6 +90,24 @@ StringResponse JsonStringResponse(
     http::status status,
     std::string_view body);
 
+// Ответ application/json (Cache-Control = no-cache) с общим телом body
+SharedStringResponse JsonSharedResponse(
+    StringRequest &&req,
+    http::status status,
+    SharedStringBody::value_type body);
+
+//  304 Not Modified без тела - у клиента уже есть версия ответа etag
+StringResponse NotModifiedResponse(
+    StringRequest &&req,
+    std::string_view etag);
+
+//  ETag "<epoch>-<version>": версия ресурса уникальна только вместе с epoch
+//  (например, номер снимка - вместе со случайным числом его сессии)
+std::string MakeETag(std::uint64_t epoch, std::uint64_t version);
+
+//  есть ли etag в значении заголовка If-None-Match (список через запятую или "*")
+bool MatchesETag(std::string_view if_none_match, std::string_view etag);
+
 //  ответ на любой запрос с "method not allowed" методом
 StringResponse InvalidMethodResponse(
     StringRequest &&req,
@@ -158,7 +158,7 @@ model::Loot::Value LoadLoot(const json::value& jsonValue) {
 
 }
 
-model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, size_t defaultBagCapacity)
+model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, size_t defaultBagCapacity, size_t defaultMaxDogs)
 {
     //
     //  Каждый элемент этого массива — объект, описывающий дороги,
@@ -167,6 +167,7 @@ model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, si
     //  name — название карты, которое выводится пользователю. Тип: строка.
     //  dogSpeed - опциональное поле задает скорость персонажей на конкретной карте. Тип: double. 
     //  bagCapacity - опциональное поле задает вместимость рюкзака на конкретной карте. Тип: uint64.
+    //  maxDogs - опциональное поле задает, сколько собак помещается в одну сессию карты. Тип: uint64.
     //  roads — дороги игровой карты. Тип: массив объектов. Массив должен содержать хотя бы один элемент.
     //  buildings — здания. Тип: массив объектов. Массив может быть пустым.
     //  offices — офисы бюро находок. Тип: массив объектов. Массив может быть пустым.
@@ -194,6 +195,16 @@ model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, si
         bagCapacity = jsonBagCapacity->as_uint64();
     }
 
+    //
+    //  Количество собак в одной сессии карты задаёт опциональное поле
+    //  maxDogs в соответствующем объекте карты. Когда все сессии карты
+    //  заполнены, для новых игроков открывается еще одна сессия.
+    //  Если это поле отсутствует, используется значение по умолчанию
+    //
+    size_t maxDogs = defaultMaxDogs;
+    if (auto const* jsonMaxDogs = jsonValue.as_object().if_contains(JsonTag::MAX_DOGS)) {
+        maxDogs = jsonMaxDogs->as_uint64();
+    }
 
     auto const &mapRoads = jsonValue.at(JsonTag::ROADS).as_array();
     auto const &mapBuildings = jsonValue.at(JsonTag::BUILDINGS).as_array();
@@ -212,7 +223,7 @@ model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, si
     //
     model::Map::Id  parsedMapId(json::value_to<std::string>(mapId));
     std::string     parsedMapName(json::value_to<std::string>(mapName));
-    model::Map      parsedMap(parsedMapId, parsedMapName, dogSpeed, bagCapacity);
+    model::Map      parsedMap(parsedMapId, parsedMapName, dogSpeed, bagCapacity, maxDogs);
 
     //
     //  Затем последовательно добавить в Map все дороги, здания, офисы
@@ -221,6 +232,11 @@ model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, si
         parsedMap.AddRoad(LoadRoad(nextRoad));
     }
 
+    //
+    //  Дороги больше не меняются - можно собрать из них граф
+    //
+    parsedMap.BuildRoadGraph();
+
     for (auto const &nextBuilding : mapBuildings) {
         parsedMap.AddBuilding(LoadBuilding(nextBuilding));
     }
@@ -244,7 +260,7 @@ model::Map LoadMap(const json::value& jsonValue, model::Real defaultDogSpeed, si
 //
 // Загрузить модель игры из уже распарсенного json::value
 //
-model::Game LoadGame(const json::value& config_json_value) {
+model::Game::Ptr LoadGame(const json::value& config_json_value) {
     //
     //  Файл содержит JSON-объект со свойствами игры:
     //  maps, defaultDogSpeed, lootGeneratorConfig
@@ -292,6 +308,16 @@ model::Game LoadGame(const json::value& config_json_value) {
         defaultBagCapacity = jsonCapacity->as_uint64();
     }
 
+    //
+    //  Количество собак в одной сессии на всех картах задаёт опциональное
+    //  поле defaultMaxDogs в корневом JSON-объекте. Если это поле
+    //  отсутствует (или равно 0), у карты всего одна сессия без ограничений.
+    //
+    size_t defaultMaxDogs = 0;
+    if (auto const* jsonMaxDogs = config_json_value.as_object().if_contains(JsonTag::DEFAULT_MAX_DOGS)) {
+        defaultMaxDogs = jsonMaxDogs->as_uint64();
+    }
+
     //
     //  Параметры генератора потерянных вещей
     //
@@ -304,10 +330,10 @@ model::Game LoadGame(const json::value& config_json_value) {
     //  Собрать всё из конфиг файла и загрузить в игру
     //
 
-    model::Game game{periodMilliseconds, probability, dogRetirementTime};
+    auto game = std::make_shared<model::Game>(periodMilliseconds, probability, dogRetirementTime);
 
     for (auto const &nextMap : mapsArray) {
-        game.AddMap(LoadMap(nextMap, defaultDogSpeed, defaultBagCapacity));
+        game->AddMap(LoadMap(nextMap, defaultDogSpeed, defaultBagCapacity, defaultMaxDogs));
     }
 
     return game;
@@ -332,7 +358,7 @@ model::Game::Ptr LoadGame(const std::filesystem::path& json_path) {
     //
     // Загрузить модель игры из json::value
     //
-    return std::make_shared<model::Game>(LoadGame(config));
+    return LoadGame(config);
 
 }
 
@@ -1,40 +1,54 @@
 #include "../sdk.h"
-#include <boost/json.hpp>
-#include <boost/json/string_view.hpp>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <chrono>
 #include <string_view>
+#include <type_traits>
 
 #include "json_tags.h"
+#include "json_writer.h"
 #include "json_serializer.h"
 
 namespace json_serializer {
 
 using namespace std::literals;
-namespace json = boost::json;
-
 
 //
-//  Сериализую заголовок карты (ид + имя) в json::value
+//  Ответы пишутся потоково (см. JsonWriter) прямо из объектов игры и снимков
+//  сессии - без промежуточных json::object/array и строк для ключей.
+//  Порядок ключей тот же, что был у json::serialize по дереву json::object
 //
-json::object SerializeObject(const model::Map& map)
-{
-    const auto &mapId = map.GetId();
-    const auto &mapName = map.GetName();
 
-    json::object jsonObject;
+namespace {
 
-    jsonObject[JsonTag::ID] = json::value_from(*mapId);
-    jsonObject[JsonTag::NAME] = json::value_from(mapName);
+//
+//  примерные размеры объектов в JSON - чтобы заранее выделить строку целиком
+//
+constexpr size_t DOG_JSON_SIZE = 160;
+constexpr size_t BAG_ITEM_JSON_SIZE = 24;
+constexpr size_t LOOT_JSON_SIZE = 64;
+constexpr size_t PLAYER_JSON_SIZE = 32;
+constexpr size_t RECORD_JSON_SIZE = 64;
+constexpr size_t ROAD_JSON_SIZE = 40;
+constexpr size_t BUILDING_JSON_SIZE = 40;
+constexpr size_t OFFICE_JSON_SIZE = 64;
+constexpr size_t MAP_HEADER_JSON_SIZE = 128;
+
+std::string_view Tag(boost::json::string_view tag) noexcept {
+    return {tag.data(), tag.size()};
+}
 
-    return jsonObject;
+//
+//  Заголовок карты (ид + имя) - без скобок, их ставит вызывающий
+//
+void WriteMapHeader(JsonWriter& writer, const model::Map& map)
+{
+    writer.Key(Tag(JsonTag::ID)).String(*map.GetId());
+    writer.Key(Tag(JsonTag::NAME)).String(map.GetName());
 }
 
 //
-//  Координаты одной дороги - в json::object
+//  Координаты одной дороги
 //
-json::object SerializeObject(const model::Road& road)
+void WriteObject(JsonWriter& writer, const model::Road& road)
 {
     //
     //  всегда добавить x0, y0, а дальше в зависимости от направления
@@ -43,114 +57,176 @@ json::object SerializeObject(const model::Road& road)
     const auto &start = road.GetStart();
     const auto &end = road.GetEnd();
 
-    json::object serializedRoad;
-
-    serializedRoad[JsonTag::X0] = json::value_from(start.x);
-    serializedRoad[JsonTag::Y0] = json::value_from(start.y);
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::X0)).Int(start.x);
+    writer.Key(Tag(JsonTag::Y0)).Int(start.y);
     if (road.IsHorizontal()) {
         //
         //  в горизонтальной дороге заданы x0 и x1
         //
-        serializedRoad[JsonTag::X1] = json::value_from(end.x);
+        writer.Key(Tag(JsonTag::X1)).Int(end.x);
     }
     else {
         //
         //  интересно, а если дорога не горизонтальная - то какая?
         //  я надеюсь, что вертикальная (y0 и y1)
         //
-        serializedRoad[JsonTag::Y1] = json::value_from(end.y);
+        writer.Key(Tag(JsonTag::Y1)).Int(end.y);
     }
-
-    return serializedRoad;
+    writer.EndObject();
 }
 
 //
-//  Координаты (x, y, w, h) одного здания в json::object
+//  Координаты (x, y, w, h) одного здания
 //
-json::object SerializeObject(const model::Building& building)
+void WriteObject(JsonWriter& writer, const model::Building& building)
 {
     const auto &bounds = building.GetBounds();
 
-    json::object serializedBuilding;
-
-    serializedBuilding[JsonTag::X] = json::value_from(bounds.position.x);
-    serializedBuilding[JsonTag::Y] = json::value_from(bounds.position.y);
-    serializedBuilding[JsonTag::W] = json::value_from(bounds.size.width);
-    serializedBuilding[JsonTag::H] = json::value_from(bounds.size.height);
-
-    return serializedBuilding;
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::X)).Int(bounds.position.x);
+    writer.Key(Tag(JsonTag::Y)).Int(bounds.position.y);
+    writer.Key(Tag(JsonTag::W)).Int(bounds.size.width);
+    writer.Key(Tag(JsonTag::H)).Int(bounds.size.height);
+    writer.EndObject();
 }
 
 //
-//  Офис - координаты, смещение, ид в json::object
+//  Офис - координаты, смещение, ид
 //
-json::object SerializeObject(const model::Office& office)
+void WriteObject(JsonWriter& writer, const model::Office& office)
 {
     const auto &position = office.GetPosition();
     const auto &offset = office.GetOffset();
-    const auto &id = *office.GetId();
 
-    json::object serializedOffice;
-
-    serializedOffice[JsonTag::ID] = json::value_from(id);
-    serializedOffice[JsonTag::X] = json::value_from(position.x);
-    serializedOffice[JsonTag::Y] = json::value_from(position.y);
-    serializedOffice[JsonTag::OFFSETX] = json::value_from(offset.dx);
-    serializedOffice[JsonTag::OFFSETY] = json::value_from(offset.dy);
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::ID)).String(*office.GetId());
+    writer.Key(Tag(JsonTag::X)).Int(position.x);
+    writer.Key(Tag(JsonTag::Y)).Int(position.y);
+    writer.Key(Tag(JsonTag::OFFSETX)).Int(offset.dx);
+    writer.Key(Tag(JsonTag::OFFSETY)).Int(offset.dy);
+    writer.EndObject();
+}
 
-    return serializedOffice;
+void WriteObject(JsonWriter& writer, const model::Map& map)
+{
+    writer.BeginObject();
+    WriteMapHeader(writer, map);
+    writer.EndObject();
 }
 
-json::object SerializeObject(const model::Loot::Traits& bagItem)
+void WriteObject(JsonWriter& writer, const model::Loot::Traits& bagItem)
 {
-    json::object serializedBagItem;
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::ID)).UInt(bagItem.id);
+    writer.Key(Tag(JsonTag::TYPE)).UInt(bagItem.type);
+    writer.EndObject();
+}
 
-    serializedBagItem[JsonTag::ID] = json::value_from(bagItem.id);
-    serializedBagItem[JsonTag::TYPE] = json::value_from(bagItem.type);
+void WriteObject(JsonWriter& writer, const app::RecordsResult::value_type& record)
+{
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::NAME)).String(record.name);
+    writer.Key(Tag(JsonTag::SCORE)).UInt(record.score);
+    writer.Key(Tag(JsonTag::PLAY_TIME)).Double(std::chrono::duration<double>{record.play_time_ms} / std::chrono::seconds{1});
+    writer.EndObject();
+}
 
-    return serializedBagItem;
+//
+//  Список объектов всегда сериализуется по одному шаблону,
+//  поэтому делаю template
+//
+template <typename ObjectList>
+void WriteObjects(JsonWriter& writer, const ObjectList& objects)
+{
+    writer.BeginArray();
+    for (const auto &o : objects) {
+        WriteObject(writer, o);
+    }
+    writer.EndArray();
 }
 
-json::object SerializeObject(const app::RecordsResult::value_type& record)
+void WritePoint(JsonWriter& writer, double x, double y)
 {
-    json::object serializedRecord;
+    writer.BeginArray().Double(x).Double(y).EndArray();
+}
 
-    serializedRecord[JsonTag::NAME] = record.name;
-    serializedRecord[JsonTag::SCORE] = record.score;
-    serializedRecord[JsonTag::PLAY_TIME] = std::chrono::duration<double>{record.play_time_ms} / std::chrono::seconds{1};//static_cast<double>(record.play_time_ms.count()) / 1000.0;
+//
+//  Одна собака из снимка сессии
+//
+void WriteObject(JsonWriter& writer, const model::SessionSnapshot::DogState& dog)
+{
+    const char dir = static_cast<char>(dog.dir);
+
+    writer.BeginObject();
+    writer.Key("pos"sv);
+    WritePoint(writer, dog.pos.x, dog.pos.y);
+    writer.Key("speed"sv);
+    WritePoint(writer, dog.speed.x, dog.speed.y);
+    writer.Key("dir"sv).String(std::string_view{&dir, 1});
+    writer.Key("bag"sv);
+    WriteObjects(writer, dog.bag);
+    writer.Key("score"sv).UInt(dog.score);
+    writer.EndObject();
+}
 
-    return serializedRecord;
+//
+//  Один потерянный предмет из снимка сессии
+//
+void WriteObject(JsonWriter& writer, const model::SessionSnapshot::LootState& loot)
+{
+    writer.BeginObject();
+    writer.Key("type"sv).UInt(loot.type);
+    writer.Key("pos"sv);
+    WritePoint(writer, loot.pos.x, loot.pos.y);
+    writer.EndObject();
 }
 
 //
-//  Список объектов всегда сериализуется по одному шаблону,
-//  поэтому делаю template
+//  Объект "ид -> состояние"; элементы - сами состояния или указатели на них
 //
-template <typename ObjectList>
-json::array SerializeObjects(const ObjectList& objects)
+template <typename States>
+void WriteStates(JsonWriter& writer, const States& states)
 {
-    json::array jsonObjects;
+    writer.BeginObject();
+    for (const auto& state : states) {
+        if constexpr (std::is_pointer_v<std::decay_t<decltype(state)>>) {
+            WriteObject(writer.Key(state->id), *state);
+        }
+        else {
+            WriteObject(writer.Key(state.id), state);
+        }
+    }
+    writer.EndObject();
+}
 
-    for (const auto &o : objects) {
-        //
-        //  последовательно сериализую в json::object каждый объект из списка
-        //  и помещаю (через move) в массив json::array
-        //
-        jsonObjects.emplace_back(SerializeObject(o));
+template <typename Ids>
+void WriteIds(JsonWriter& writer, const Ids& ids)
+{
+    writer.BeginArray();
+    for (auto id : ids) {
+        writer.UInt(id);
     }
+    writer.EndArray();
+}
 
-    return jsonObjects;
+size_t EstimateSize(const model::SessionSnapshot::DogState& dog) noexcept {
+    return DOG_JSON_SIZE + dog.bag.size() * BAG_ITEM_JSON_SIZE;
 }
 
+} // namespace
+
 
 //
 //  Список карт (ид + имя карты) в строку JSON
 //
 std::string SerializeMapList(const model::Game::Maps& maps)
 {
-    json::array jsonMapList = SerializeObjects(maps);
+    JsonWriter writer{maps.size() * MAP_HEADER_JSON_SIZE};
+
+    WriteObjects(writer, maps);
 
-    return json::serialize(jsonMapList);
+    return writer.Release();
 }
 
 //
@@ -158,98 +234,121 @@ std::string SerializeMapList(const model::Game::Maps& maps)
 //
 std::string SerializeMap(const model::Map& map)
 {
-    //
-    //  заголовок я уже умею сериализовать
-    //
-    json::object jsonMapObject = SerializeObject(map);
+    JsonWriter writer{
+        MAP_HEADER_JSON_SIZE
+        + map.GetRoads().size() * ROAD_JSON_SIZE
+        + map.GetBuildings().size() * BUILDING_JSON_SIZE
+        + map.GetOffices().size() * OFFICE_JSON_SIZE
+        + map.GetFrontendData().size()};
+
+    writer.BeginObject();
 
     //
-    //  теперь к заголовку нужно добавить дороги, здания, офисы
+    //  заголовок, а к нему дороги, здания, офисы
     //
-    jsonMapObject[JsonTag::ROADS] = SerializeObjects(map.GetRoads());
-    jsonMapObject[JsonTag::BUILDINGS] = SerializeObjects(map.GetBuildings());
-    jsonMapObject[JsonTag::OFFICES] = SerializeObjects(map.GetOffices());
+    WriteMapHeader(writer, map);
+    writer.Key(Tag(JsonTag::ROADS));
+    WriteObjects(writer, map.GetRoads());
+    writer.Key(Tag(JsonTag::BUILDINGS));
+    WriteObjects(writer, map.GetBuildings());
+    writer.Key(Tag(JsonTag::OFFICES));
+    WriteObjects(writer, map.GetOffices());
 
     //
-    //  и еще потерянные вещи
+    //  и еще потерянные вещи - они уже хранятся в карте в виде,
+    //  который выдает json::serialize (см. json_loader)
     //
-    jsonMapObject[JsonTag::LOOT_TYPES] = json::parse(map.GetFrontendData());
+    writer.Key(Tag(JsonTag::LOOT_TYPES)).Raw(map.GetFrontendData());
+
+    writer.EndObject();
 
-    return json::serialize(jsonMapObject);
+    return writer.Release();
 }
 
 //
 //  Сериализую результат операции Вход в игру
 //
-json::object SerializeObject(const app::JoinGameResult &token_and_id)
-{
-    json::object jsonObject;
-
-    jsonObject[JsonTag::AUTH_TOKEN] = json::value_from(*token_and_id.token);
-    jsonObject[JsonTag::PLAYER_ID] = json::value_from(token_and_id.id);
-
-    return jsonObject;
-}
-
 std::string SerializeJoinResult(const app::JoinGameResult &token_and_id)
 {
-//    json::value jsonTokenAndId{ {"authToken", token_and_id.token}, {"playerId", token_and_id.id} };
-    auto jsonTokenAndId = SerializeObject(token_and_id);
+    JsonWriter writer{MAP_HEADER_JSON_SIZE};
+
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::AUTH_TOKEN)).String(*token_and_id.token);
+    writer.Key(Tag(JsonTag::PLAYER_ID)).UInt(token_and_id.id);
+    writer.EndObject();
 
-    return json::serialize(jsonTokenAndId);
+    return writer.Release();
 }
 
 std::string SerializePlayersResult(const app::PlayersResult &players)
 {
-    json::object jsonObject;
+    JsonWriter writer{players->size() * PLAYER_JSON_SIZE + 2};
 
-    for (const auto& player : players) {
-        std::string id = std::to_string(player.first);
-
-        jsonObject[id] = {{"name", player.second}};
+    writer.BeginObject();
+    for (const auto& player : *players) {
+        writer.Key(player.id).BeginObject();
+        writer.Key("name"sv).String(player.name);
+        writer.EndObject();
     }
+    writer.EndObject();
 
-    return json::serialize(jsonObject);
+    return writer.Release();
 }
 
-std::string SerializeStateResult(const app::StateResult &state)
+std::string SerializeStateResult(const model::SessionSnapshot &state)
 {
-    json::object jsonPlayers;
-
-    for (const auto& player : state.players) {
-        std::string id = std::to_string(std::get<app::StateResult::DogId>(player));
-        json::array pos = { std::get<app::StateResult::DogPos>(player).x, std::get<app::StateResult::DogPos>(player).y };
-        json::array speed = { std::get<app::StateResult::DogSpeed>(player).x, std::get<app::StateResult::DogSpeed>(player).y };
-        std::string dir = std::string(1, static_cast<char>(std::get<app::StateResult::DogDir>(player)));
-        json::array bag = SerializeObjects(std::get<app::StateResult::DogBag>(player));
-        auto score = std::get<app::StateResult::DogScore>(player);
-
-        jsonPlayers[id] = {{"pos", pos}, {"speed", speed}, {"dir", dir}, {"bag", bag}, {"score", score}};
+    size_t size = 64 + state.loots.size() * LOOT_JSON_SIZE;
+    for (const auto& dog : state.dogs) {
+        size += EstimateSize(dog);
     }
 
-    json::object jsonLoots;
+    JsonWriter writer{size};
 
-    for (const auto& loot : state.loots) {
-        std::string id = std::to_string(std::get<0>(loot));
-        model::Loot::Type type = std::get<1>(loot);
-        json::array pos = {std::get<2>(loot).x, std::get<2>(loot).y};
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::PLAYERS));
+    WriteStates(writer, state.dogs);
+    writer.Key(Tag(JsonTag::LOST_OBJECTS));
+    WriteStates(writer, state.loots);
+    writer.EndObject();
 
-        jsonLoots[id] = {{"type", type}, {"pos", pos}};
-    }
+    return writer.Release();
+}
 
-    json::object jsonResult;
+std::string SerializeStateDelta(const model::SessionSnapshot &state, const model::SessionSnapshot &base)
+{
+    const auto delta = state.MakeDelta(base);
 
-    jsonResult[JsonTag::PLAYERS] = jsonPlayers;
-    jsonResult[JsonTag::LOST_OBJECTS] = jsonLoots;
+    size_t size = 128
+        + delta.loots.size() * LOOT_JSON_SIZE
+        + (delta.removed_dogs.size() + delta.removed_loots.size()) * 12;
+    for (const auto* dog : delta.dogs) {
+        size += EstimateSize(*dog);
+    }
 
-    return json::serialize(jsonResult);
+    JsonWriter writer{size};
+
+    writer.BeginObject();
+    writer.Key(Tag(JsonTag::SINCE)).UInt(base.generation);
+    writer.Key(Tag(JsonTag::PLAYERS));
+    WriteStates(writer, delta.dogs);
+    writer.Key(Tag(JsonTag::LOST_OBJECTS));
+    WriteStates(writer, delta.loots);
+    writer.Key(Tag(JsonTag::REMOVED_PLAYERS));
+    WriteIds(writer, delta.removed_dogs);
+    writer.Key(Tag(JsonTag::REMOVED_LOST_OBJECTS));
+    WriteIds(writer, delta.removed_loots);
+    writer.EndObject();
+
+    return writer.Release();
 }
 
 std::string SerializeRecordsResult(const app::RecordsResult &records) {
 
-    json::array jsonPlayers = SerializeObjects(records);
+    JsonWriter writer{records.size() * RECORD_JSON_SIZE + 2};
+
+    WriteObjects(writer, records);
 
-    return json::serialize(jsonPlayers);
+    return writer.Release();
 }
 
 
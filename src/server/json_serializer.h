@@ -13,7 +13,14 @@ std::string SerializeMap(const model::Map& map);
 
 std::string SerializeJoinResult(const app::JoinGameResult &token_and_id);
 std::string SerializePlayersResult(const app::PlayersResult &players);
-std::string SerializeStateResult(const app::StateResult &state);
+std::string SerializeStateResult(const model::SessionSnapshot &state);
+
+//
+//  Изменения состояния с более старого снимка base: новые и изменившиеся
+//  собаки и предметы в том же виде, что и в полном состоянии, и списки
+//  идентификаторов исчезнувших
+//
+std::string SerializeStateDelta(const model::SessionSnapshot &state, const model::SessionSnapshot &base);
 std::string SerializeRecordsResult(const app::RecordsResult &records);
 
 }  // namespace json_serializer
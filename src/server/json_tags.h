@@ -32,6 +32,8 @@ struct JsonTag {
 static constexpr boost::json::string_view LOOT_TYPES = "lootTypes";
     static constexpr boost::json::string_view DEFAULT_BAG_CAPACITY = "defaultBagCapacity";
     static constexpr boost::json::string_view BAG_CAPACITY = "bagCapacity";
+    static constexpr boost::json::string_view DEFAULT_MAX_DOGS = "defaultMaxDogs";
+    static constexpr boost::json::string_view MAX_DOGS = "maxDogs";
     
     static constexpr boost::json::string_view LOOT_GENERATOR_CONFIG = "lootGeneratorConfig";
     static constexpr boost::json::string_view PERIOD      = "period";
@@ -45,6 +47,9 @@ static constexpr boost::json::string_view LOOT_TYPES = "lootTypes";
     static constexpr boost::json::string_view MOVE       = "move";
     static constexpr boost::json::string_view TIME_DELTA = "timeDelta";
     static constexpr boost::json::string_view LOST_OBJECTS = "lostObjects";
+    static constexpr boost::json::string_view REMOVED_PLAYERS = "removedPlayers";
+    static constexpr boost::json::string_view REMOVED_LOST_OBJECTS = "removedLostObjects";
+    static constexpr boost::json::string_view SINCE = "since";
 
     static constexpr boost::json::string_view SCORE = "score";
     static constexpr boost::json::string_view PLAY_TIME = "playTime";
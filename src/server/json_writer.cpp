@@ -0,0 +1,182 @@
+#include "../sdk.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "json_writer.h"
+
+namespace json_serializer {
+
+using namespace std::literals;
+
+JsonWriter::JsonWriter(size_t capacity) {
+    out_.reserve(capacity);
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+    BeginValue();
+    out_.push_back('{');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    out_.push_back('}');
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+    BeginValue();
+    out_.push_back('[');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+    out_.push_back(']');
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+    String(key);
+    out_.push_back(':');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::uint64_t key) {
+    BeginValue();
+
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), key);
+
+    out_.push_back('"');
+    out_.append(buffer, end);
+    out_.append("\":"sv);
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+    BeginValue();
+    out_.push_back('"');
+
+    //
+    //  Экранирование как у boost::json: кавычка, обратная косая черта
+    //  и управляющие символы; остальное (в т.ч. utf-8) копируется кусками
+    //
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    size_t run = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const auto ch = static_cast<unsigned char>(value[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+
+        out_.append(value.substr(run, i - run));
+        run = i + 1;
+
+        switch (ch) {
+        case '"':  out_.append("\\\""sv); break;
+        case '\\': out_.append("\\\\"sv); break;
+        case '\b': out_.append("\\b"sv); break;
+        case '\f': out_.append("\\f"sv); break;
+        case '\n': out_.append("\\n"sv); break;
+        case '\r': out_.append("\\r"sv); break;
+        case '\t': out_.append("\\t"sv); break;
+        default:
+            out_.append("\\u00"sv);
+            out_.push_back(HEX[ch >> 4]);
+            out_.push_back(HEX[ch & 0xf]);
+        }
+    }
+    out_.append(value.substr(run));
+
+    out_.push_back('"');
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Int(std::int64_t value) {
+    BeginValue();
+
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::UInt(std::uint64_t value) {
+    BeginValue();
+
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+    BeginValue();
+
+    char buffer[MAX_DOUBLE_LENGTH];
+    out_.append(buffer, FormatDouble(buffer, value));
+
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+    BeginValue();
+    out_.append(json);
+    need_comma_ = true;
+    return *this;
+}
+
+/*static*/ size_t JsonWriter::FormatDouble(char* buffer, double value) noexcept {
+
+    //
+    //  бесконечности и NaN - так, как их пишет Ryu (d2s) внутри boost::json
+    //
+    if (!std::isfinite(value)) {
+        const auto special = std::isnan(value) ? "NaN"sv : (value < 0 ? "-Infinity"sv : "Infinity"sv);
+        std::copy(special.begin(), special.end(), buffer);
+        return special.size();
+    }
+
+    //
+    //  to_chars дает те же кратчайшие цифры, что и Ryu, но в виде "-1.5e+01":
+    //  мантисса переносится как есть, а порядок - без '+' и ведущих нулей
+    //
+    char scientific[MAX_DOUBLE_LENGTH];
+    auto [end, ec] = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific);
+
+    const char* exponent = std::find(scientific, end, 'e');
+    char* out = std::copy(static_cast<const char*>(scientific), exponent, buffer);
+
+    *out++ = 'E';
+    if (*++exponent == '-') {
+        *out++ = '-';
+    }
+    ++exponent;
+    while (exponent + 1 < end && *exponent == '0') {
+        ++exponent;
+    }
+    out = std::copy(exponent, static_cast<const char*>(end), out);
+
+    return static_cast<size_t>(out - buffer);
+}
+
+void JsonWriter::BeginValue() {
+    if (need_comma_) {
+        out_.push_back(',');
+    }
+}
+
+} // namespace json_serializer
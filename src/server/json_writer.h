@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace json_serializer {
+
+//
+//  Потоковая запись JSON прямо в строку - без промежуточного дерева
+//  boost::json::object/array. Вывод побайтно совпадает с json::serialize:
+//  без пробелов, строки экранируются так же, а числа с плавающей точкой
+//  записываются кратчайшим представлением, которое читается обратно в то же
+//  число (std::to_chars), в формате Ryu, как у boost::json: 1.5E0, 1E1, 4E-1.
+//
+//  Запятые между элементами расставляет сам писатель, вызывающий только
+//  соблюдает порядок: Key перед каждым значением внутри объекта
+//
+class JsonWriter {
+public:
+    //
+    //  capacity - ожидаемый размер результата, чтобы строка не перевыделялась
+    //
+    explicit JsonWriter(size_t capacity = 0);
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+
+    JsonWriter& Key(std::string_view key);
+
+    //
+    //  числовой ключ (идентификаторы собак, трофеев) - без std::to_string
+    //
+    JsonWriter& Key(std::uint64_t key);
+
+    JsonWriter& String(std::string_view value);
+    JsonWriter& Int(std::int64_t value);
+    JsonWriter& UInt(std::uint64_t value);
+    JsonWriter& Double(double value);
+
+    //
+    //  готовый (уже сериализованный) JSON вставляется как есть
+    //
+    JsonWriter& Raw(std::string_view json);
+
+    std::string Release() noexcept {
+        return std::move(out_);
+    }
+
+    //
+    //  число с плавающей точкой в формате boost::json; buffer - не меньше
+    //  MAX_DOUBLE_LENGTH байт, возвращает длину записанного
+    //
+    static constexpr size_t MAX_DOUBLE_LENGTH = 32;
+    static size_t FormatDouble(char* buffer, double value) noexcept;
+
+private:
+    void BeginValue();
+
+    std::string out_;
+    bool need_comma_ = false;
+};
+
+} // namespace json_serializer
@@ -149,6 +149,35 @@ struct game_tick
     bool error = false;
 };
 
+//
+//  Тики не успевают к сроку: сколько сроков пропущено, сколько периодов
+//  игрового времени отброшено и насколько тик опоздал
+//
+struct tick_overload
+{
+    tick_overload(std::uint64_t missed, std::uint64_t shed, std::int64_t lateness_ms)
+    : custom_data{{"missedDeadlines"s, missed}, {"shedPeriods"s, shed}, {"lateness"s, lateness_ms}} {}
+
+    boost::json::value custom_data;
+    bool error = true;
+};
+
+//
+//  Итоговая статистика тиков: durations - число тиков с длительностью
+//  до 1/8, 1/4, 1/2, 1, 2 периодов и дольше, lateness - так же по опозданию
+//  срабатывания таймера (разброс периода тиков)
+//
+struct ticker_stats
+{
+    ticker_stats(std::uint64_t ticks, std::uint64_t missed, std::uint64_t shed, std::int64_t max_duration_us,
+                 const boost::json::array& durations, const boost::json::array& lateness)
+    : custom_data{{"ticks"s, ticks}, {"missedDeadlines"s, missed}, {"shedPeriods"s, shed},
+                  {"maxDuration"s, max_duration_us}, {"durations"s, durations}, {"lateness"s, lateness}} {}
+
+    boost::json::value custom_data;
+    bool error = false;
+};
+
 template <typename T>
 void Trace(const T& attributes, std::string_view message)
 {
@@ -12,6 +12,7 @@
 #include "json_loader.h"
 #include "request_handler.h"
 #include "command_line.h"
+#include "tick_thread.h"
 #include "logger.h"
 
 using namespace std::literals;
@@ -55,6 +56,32 @@ std::string GetDatabaseUrlFromEnv() {
     return db_url;
 }
 
+//
+//  Политика опоздавших тиков по имени из командной строки
+//  (имя уже проверено при разборе параметров)
+//
+model::OverloadPolicy ParseOverloadPolicy(const std::string& name) {
+    if (name == "multi-step"sv) {
+        return model::OverloadPolicy::MultiStep;
+    }
+    if (name == "shed"sv) {
+        return model::OverloadPolicy::Shed;
+    }
+    return model::OverloadPolicy::CatchUp;
+}
+
+void TraceTickerStats(const model::Ticker& ticker) {
+    const auto stats = ticker.GetStats();
+    logger::Trace(logger::ticker_stats(
+        stats.ticks,
+        stats.missed_deadlines,
+        stats.shed_periods,
+        stats.max_duration.count(),
+        boost::json::array(stats.durations.begin(), stats.durations.end()),
+        boost::json::array(stats.lateness.begin(), stats.lateness.end())),
+        "ticker stats"sv);
+}
+
 }  // namespace
 
 
@@ -79,12 +106,17 @@ int main(int argc, const char *argv[])
         }
 
         // Создать подключение к Postgres - достаточно одного подключения, поскольку
-        // все операции с БД сериализованы
+        // все операции с БД сериализованы (внутри Database)
         postgres::Database db(GetDatabaseUrlFromEnv());
 
         // Загрузить карту из файла и построить модель игры
         auto game = json_loader::LoadGame(args->congig_file);
 
+        // Зерно случайных чисел нужно задать до появления первой сессии
+        if (args->random_seed) {
+            game->SetRandomSeed(*args->random_seed);
+        }
+
 
         // Создать объект приложения, который отвечает за игроков и сценарии использования
         auto application = std::make_shared<app::Application>(game, db, args->randomize_spawn_points);
@@ -122,10 +154,13 @@ int main(int argc, const char *argv[])
                 ioc.stop();
             } });
 
-        // strand для выполнения запросов к API (пока что синхронизация сделана через мьютекс)
+        // strand для запросов к API, не связанных с сессией (запросы к сессиям выполняются
+        // в strand сессий внутри приложения) и для таймера
         auto apiStrand = net::make_strand(ioc);
 
         // нужно ли запускать таймер внутри игры?
+        model::Ticker::Ptr ticker;
+        std::optional<util::TickThread> tick_thread;
         if (args->tick_period) {
             //
             //  просят включить таймер внутри игры - включаю
@@ -133,12 +168,28 @@ int main(int argc, const char *argv[])
             //  а вот действие по таймеру будет выполняться на уровне app, поскольку отработка "тика" -
             //  это сценарий использования
             //
-            auto ticker = std::make_shared<model::Ticker>(
-                apiStrand,
+            //  по желанию - в отдельном потоке, чтобы тики и HTTP-запросы не задерживали друг друга
+            //
+            auto tickStrand = apiStrand;
+            if (args->tick_thread) {
+                tick_thread.emplace(args->tick_cpus);
+                tickStrand = tick_thread->MakeStrand();
+            }
+
+            ticker = std::make_shared<model::Ticker>(
+                tickStrand,
                 std::chrono::milliseconds(args->tick_period),
                 [application](std::chrono::milliseconds delta) {
                     application->Tick(delta);
-                });
+                },
+                model::TickerSettings{ParseOverloadPolicy(args->tick_overload_policy), args->tick_max_steps});
+            ticker->SetOverloadHandler([](const model::Ticker::Overload& overload) {
+                logger::Trace(logger::tick_overload(
+                    overload.missed_deadlines,
+                    overload.shed_periods,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(overload.lateness).count()),
+                    "tick overload"sv);
+            });
             game->SetTicker(ticker);
             ticker->Start();
         }
@@ -160,9 +211,25 @@ int main(int argc, const char *argv[])
         RunWorkers(std::max(1u, num_threads), [&ioc]
                    { ioc.run(); });
 
+        //
+        //  таймер в отдельном потоке сам не остановится - останавливаю,
+        //  чтобы тики не шли во время сохранения. Тикер держит таймер потока,
+        //  поэтому отпускаю его раньше, чем удалится поток
+        //
+        if (tick_thread) {
+            tick_thread->Stop();
+        }
+
+        if (ticker) {
+            TraceTickerStats(*ticker);
+            game->SetTicker(nullptr);
+            ticker.reset();
+        }
+        tick_thread.reset();
+
         // Если задан файл с состоянием - сохранить состояние игры
         if (!args->state_file.empty()) {
-            serialization::SaveGameState(args->state_file, game, application);
+            serialization::SaveGameState(args->state_file, application);
         }
 
         logger::Trace(logger::server_exited(0), "server exited"sv);
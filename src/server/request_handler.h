@@ -1,5 +1,6 @@
 #pragma once
 #include <filesystem>
+#include <boost/asio/dispatch.hpp>
 #include "logger.h"
 #include "http_server.h"
 #include "api_handler.h"
@@ -34,26 +35,57 @@ public:
 
         logger::TraceRequest(req);
 
+        if (!ApiRequestHandler::IsApiRequest(req)) {
+            return HandleRequest(std::forward<decltype(req)>(req), std::forward<Send>(send), start_ts);
+        }
+
+        //
+        //  Потокобезопасные запросы (команды игроков) выполняются сразу
+        //
+        if (api_request_handler_.RunsInPlace(req)) {
+            return HandleRequest(std::forward<decltype(req)>(req), std::forward<Send>(send), start_ts);
+        }
+
+        //
+        //  Запросы к API, которые касаются сессии, выполняются в strand
+        //  этой сессии - тогда запросы к разным картам не ждут друг друга.
+        //  Все остальные - в общем strand для API
+        //
+        auto strand = api_request_handler_.SelectStrand(req);
+
+        auto handle = [self = shared_from_this(), req = std::forward<decltype(req)>(req), send = std::forward<Send>(send), start_ts]() mutable {
+            self->HandleRequest(std::move(req), std::move(send), start_ts);
+        };
+
+        if (strand) {
+            boost::asio::dispatch(*strand, std::move(handle));
+        }
+        else {
+            boost::asio::dispatch(api_strand_, std::move(handle));
+        }
+    }
+
+private:
+    template <typename Send>
+    void HandleRequest(StringRequest&& req, Send&& send, std::chrono::system_clock::time_point start_ts) {
         //
         //  Обработать запрос request и отправить ответ, используя send
         //  Проблема - ответы могут быть разного типа
         //  поэтому приходится использовать std::variant + паттерн visitor
         //
-        VariantResponse varResp = MakeResponse(std::forward<decltype(req)>(req));
+        VariantResponse varResp = MakeResponse(std::move(req));
 
         logger::TraceResponse(start_ts, varResp);
 
         std::visit(send, varResp);
-
     }
 
-private:
     VariantResponse MakeResponse(StringRequest &&req);
 
     FileRequestHandler file_request_handler_;
     ApiRequestHandler api_request_handler_;
 
-    // пока не используется, чуть позже, пока на мьютексе
+    // strand для запросов к API, не связанных с конкретной сессией
     Strand api_strand_;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+namespace http_handler {
+
+//
+//  Тело ответа - неизменяемая строка, общая для многих ответов. Одно и то же
+//  сериализованное состояние уходит всем игрокам сессии без копирования:
+//  каждый ответ держит только ссылку на строку, пока ответ отправляется.
+//  Только для ответов - читать запросы в такое тело нельзя
+//
+struct SharedStringBody {
+    using value_type = std::shared_ptr<const std::string>;
+
+    static std::uint64_t size(const value_type& body) noexcept {
+        return body ? body->size() : 0;
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body) {
+        }
+
+        void init(boost::beast::error_code& ec) {
+            ec = {};
+        }
+
+        //
+        //  вся строка отдается одним буфером
+        //
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& ec) {
+            ec = {};
+
+            if (!body_ || body_->empty()) {
+                return boost::none;
+            }
+
+            return std::make_pair(const_buffers_type{body_->data(), body_->size()}, false);
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+} // namespace http_handler
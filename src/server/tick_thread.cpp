@@ -0,0 +1,75 @@
+#include "../sdk.h"
+#include <system_error>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "tick_thread.h"
+
+namespace util {
+
+namespace {
+
+void PinThread(std::thread& thread, const std::vector<unsigned>& cpus) {
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            throw std::system_error(EINVAL, std::generic_category(), "tick thread cpu");
+        }
+        CPU_SET(cpu, &set);
+    }
+
+    if (int err = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set)) {
+        throw std::system_error(err, std::generic_category(), "tick thread affinity");
+    }
+#else
+    throw std::system_error(std::make_error_code(std::errc::not_supported), "tick thread affinity");
+#endif
+}
+
+} // namespace
+
+TickThread::TickThread(const std::vector<unsigned>& cpus)
+: work_(net::make_work_guard(ioc_))
+, thread_([this] { ioc_.run(); }) {
+
+    if (cpus.empty()) {
+        return;
+    }
+
+    //
+    //  работы в потоке еще нет, поэтому привязать его можно и после запуска
+    //
+    try {
+        PinThread(thread_, cpus);
+    }
+    catch (...) {
+        Stop();
+        throw;
+    }
+}
+
+TickThread::~TickThread() {
+    Stop();
+}
+
+TickThread::Strand TickThread::MakeStrand() {
+    return net::make_strand(ioc_);
+}
+
+void TickThread::Stop() {
+
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    work_.reset();
+    ioc_.stop();
+    thread_.join();
+}
+
+} // namespace util
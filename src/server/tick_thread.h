@@ -0,0 +1,45 @@
+#pragma once
+#include <thread>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/strand.hpp>
+
+namespace util {
+
+namespace net = boost::asio;
+
+//
+//  Отдельный поток со своим io_context для таймера игры: HTTP-запросы
+//  обрабатываются в другом io_context и не задерживают тики, а ожидание
+//  тика (Application::Tick ждет, пока протикают все сессии) не занимает
+//  поток, который мог бы отвечать на запросы. Сессии по-прежнему тикают
+//  в своих strand - через их очереди обработчиков тик и доходит до сессий.
+//
+//  Поток можно привязать к заданному набору процессоров (cpus) - тогда
+//  на время срабатывания таймера не влияют соседи по ядру
+//
+class TickThread {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    explicit TickThread(const std::vector<unsigned>& cpus = {});
+    ~TickThread();
+
+    TickThread(const TickThread&) = delete;
+    TickThread& operator=(const TickThread&) = delete;
+
+    Strand MakeStrand();
+
+    //
+    //  Остановить поток и дождаться его завершения (после этого тиков не будет)
+    //
+    void Stop();
+
+private:
+    net::io_context ioc_{1};
+    net::executor_work_guard<net::io_context::executor_type> work_;
+    std::thread thread_;
+};
+
+} // namespace util
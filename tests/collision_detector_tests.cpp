@@ -1,9 +1,11 @@
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <vector>
 #include <sstream>
+#include <random>
 
 
 #include <catch2/catch_test_macros.hpp>
@@ -147,6 +149,36 @@ MakeGathererProvider_GatherersDontMove() {
     return std::make_pair(prov, std::vector<GatheringEvent>{});
 }
 
+//
+//  Много предметов и сборщиков, раскиданных случайно по карте -
+//  так, чтобы сработал поиск через сетку
+//
+LootGathererProvider MakeGathererProvider_Random(unsigned seed, size_t items_count, size_t gatherers_count) {
+
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<double> coord{-50.0, 50.0};
+    std::uniform_real_distribution<double> step{-3.0, 3.0};
+    std::uniform_real_distribution<double> width{0.0, 0.6};
+
+    LootGathererProvider prov;
+
+    for (size_t i = 0; i < items_count; ++i) {
+        prov.AddItem({coord(generator), coord(generator)}, width(generator), i);
+    }
+
+    for (size_t g = 0; g < gatherers_count; ++g) {
+        geom::Point2D start{coord(generator), coord(generator)};
+        //
+        //  собаки ходят только по горизонтали или вертикали
+        //
+        geom::Point2D end = (g % 2) ? geom::Point2D{start.x + step(generator), start.y}
+                                    : geom::Point2D{start.x, start.y + step(generator)};
+        prov.AddGatherer(start, end, width(generator), g);
+    }
+
+    return prov;
+}
+
 
 TEST_CASE( "Collision detection", "[no-items]" ) {
 
@@ -194,3 +226,157 @@ TEST_CASE( "Collision detection", "[gatherers-dont-move]" ) {
     CHECK(events.empty());
 }
 
+TEST_CASE( "Collision detection", "[grid-matches-brute-force]" ) {
+
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        auto prov = MakeGathererProvider_Random(seed, 2000, 500);
+        auto etalon = geom::FindGatherEventsBruteForce(prov);
+        auto events = FindGatherEvents(prov);
+
+        INFO("seed: " << seed);
+        REQUIRE(!etalon.empty());
+        REQUIRE(events.size() == etalon.size());
+
+        for (size_t i = 0; i < etalon.size(); ++i) {
+            CHECK(events[i].gatherer_id == etalon[i].gatherer_id);
+            CHECK(events[i].item_id == etalon[i].item_id);
+            CHECK(events[i].sq_distance == etalon[i].sq_distance);
+            CHECK(events[i].time == etalon[i].time);
+        }
+    }
+}
+
+TEST_CASE( "Collision detection", "[spans-match-provider]" ) {
+
+    auto prov = MakeGathererProvider_Random(7, 500, 200);
+    auto etalon = FindGatherEvents(prov);
+    auto events = FindGatherEvents(prov.GetItems(), prov.GetGatherers());
+    auto brute_force = geom::FindGatherEventsBruteForce(prov.GetItems(), prov.GetGatherers());
+
+    REQUIRE(!etalon.empty());
+    REQUIRE(events.size() == etalon.size());
+    REQUIRE(brute_force.size() == etalon.size());
+
+    for (size_t i = 0; i < etalon.size(); ++i) {
+        CHECK(events[i] == etalon[i]);
+        CHECK(brute_force[i] == etalon[i]);
+    }
+}
+
+TEST_CASE( "Collision detection", "[batch-matches-scalar]" ) {
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(-10.0, 10.0);
+    std::uniform_real_distribution<double> width(0.0, 1.0);
+
+    for (size_t count : {0, 1, 3, 4, 5, 7, 8, 63, 64, 1001}) {
+
+        std::vector<double> xs(count), ys(count), widths(count);
+        for (size_t i = 0; i < count; ++i) {
+            xs[i] = coord(gen);
+            ys[i] = coord(gen);
+            widths[i] = width(gen);
+        }
+
+        //
+        //  точки на концах отрезка и ровно на границе радиуса
+        //
+        if (count >= 4) {
+            xs[0] = 0.0; ys[0] = 0.0;
+            xs[1] = 10.0; ys[1] = 0.0;
+            xs[2] = 5.0; ys[2] = 1.0; widths[2] = 0.5;
+            xs[3] = 10.0; ys[3] = 0.5; widths[3] = 0.0;
+        }
+
+        //
+        //  вдоль оси X, против оси Y (проверка без деления) и по диагонали (общая проверка)
+        //
+        const std::pair<geom::Point2D, geom::Point2D> sweeps[] = {
+            {{0.0, 0.0}, {10.0, 0.0}},
+            {{0.0, 10.0}, {0.0, 0.0}},
+            {{0.0, 0.0}, {10.0, 10.0}}
+        };
+
+        for (const auto& [a, b] : sweeps) {
+            const double gatherer_width = 0.5;
+
+            std::vector<geom::CollectionHit> hits(count);
+            const size_t hits_count = geom::TryCollectPoints(a, b, gatherer_width,
+                                                             xs.data(), ys.data(), widths.data(), count,
+                                                             hits.data());
+
+            std::vector<geom::CollectionHit> etalon;
+            for (size_t i = 0; i < count; ++i) {
+                auto result = geom::TryCollectPoint(a, b, {xs[i], ys[i]});
+                if (result.IsCollected(gatherer_width + widths[i])) {
+                    etalon.push_back({i, result});
+                }
+            }
+
+            INFO("count: " << count << ", from: " << a.x << "," << a.y << " to: " << b.x << "," << b.y);
+            REQUIRE(hits_count == etalon.size());
+
+            for (size_t i = 0; i < hits_count; ++i) {
+                CHECK(hits[i].index == etalon[i].index);
+                CHECK(hits[i].result.sq_distance == etalon[i].result.sq_distance);
+                CHECK(hits[i].result.proj_ratio == etalon[i].result.proj_ratio);
+            }
+        }
+    }
+}
+
+TEST_CASE( "Collision detection", "[axis-aligned-boundary-matches-brute-force]" ) {
+
+    //
+    //  Координаты с шагом 0.1 (не представимым точно), предметы - ровно на
+    //  расстоянии радиуса от линии движения и на концах отрезка: именно там
+    //  проверка вдоль оси может разойтись с общей формулой из-за округления
+    //
+    std::mt19937 gen(2024);
+    std::uniform_int_distribution<int> tenth(-200, 200);
+    std::uniform_int_distribution<int> length(1, 40);
+    std::uniform_int_distribution<int> coin(0, 1);
+    const double widths[] = {0.0, 0.1, 0.3, 0.6};
+    std::uniform_int_distribution<size_t> pick_width(0, std::size(widths) - 1);
+
+    for (int sweep = 0; sweep < 2000; ++sweep) {
+
+        const bool along_x = coin(gen);
+        const double from = tenth(gen) / 10.0;
+        const double to = from + (coin(gen) ? 1 : -1) * length(gen) / 10.0;
+        const double line = tenth(gen) / 10.0;
+        const double gatherer_width = widths[pick_width(gen)];
+
+        const geom::Point2D a = along_x ? geom::Point2D{from, line} : geom::Point2D{line, from};
+        const geom::Point2D b = along_x ? geom::Point2D{to, line} : geom::Point2D{line, to};
+
+        std::vector<geom::Item> items;
+        for (size_t i = 0; i < 32; ++i) {
+            const double item_width = widths[pick_width(gen)];
+            const double main = (i % 4 == 0) ? from : (i % 4 == 1) ? to : tenth(gen) / 10.0;
+            const double cross = line + (coin(gen) ? 1 : -1) * (gatherer_width + item_width);
+            items.push_back({along_x ? geom::Point2D{main, cross} : geom::Point2D{cross, main}, item_width, i});
+        }
+
+        const geom::Gatherer gatherers[] = {{a, b, gatherer_width, 0}};
+
+        auto etalon = geom::FindGatherEventsBruteForce(items, gatherers);
+        auto events = FindGatherEvents(items, gatherers);
+
+        //
+        //  порядок одновременных событий может быть любым
+        //
+        const auto by_item = [](const GatheringEvent& lhs, const GatheringEvent& rhs) {
+            return lhs.item_id < rhs.item_id;
+        };
+        std::sort(etalon.begin(), etalon.end(), by_item);
+        std::sort(events.begin(), events.end(), by_item);
+
+        INFO("from: " << a.x << "," << a.y << " to: " << b.x << "," << b.y << " width: " << gatherer_width);
+        REQUIRE(events.size() == etalon.size());
+
+        for (size_t i = 0; i < etalon.size(); ++i) {
+            CHECK(events[i] == etalon[i]);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "../src/game/model.h"
+#include "test_maps.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::atomic<size_t> allocations_count{0};
+
+}  // namespace
+
+//
+//  Счетчик выделений памяти. Замена operator new действует на всю программу
+//  game_tests, а не только на этот файл: через нее идут выделения памяти
+//  всех тестов и бенчмарков, но считаются они только здесь
+//
+void* operator new(std::size_t size) {
+    ++allocations_count;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+constexpr model::TimeInterval TICK = 50ms;
+
+}  // namespace
+
+SCENARIO("Collision world of a session") {
+    GIVEN("a session with an office, live loot generation and running dogs") {
+        const auto map = test_maps::MakeCityMap(5, 4.0);
+
+        //
+        //  трофеи появляются почти каждую секунду, пока их меньше, чем собак, -
+        //  на каждом тике трофеи и появляются, и подбираются
+        //
+        model::GameSession session{map, 1s, 0.9, 42};
+
+        constexpr size_t DOGS_COUNT = 100;
+        test_maps::AddRunningDogs(session, DOGS_COUNT);
+
+        //
+        //  разгон: трофеев становится столько, сколько собак (больше генератор
+        //  не создает), и история снимков заполняется
+        //
+        size_t max_loots = 0;
+        for (size_t i = 0; i < 20 * model::GameSession::SNAPSHOT_HISTORY; ++i) {
+            session.Tick(TICK);
+            session.PublishSnapshot();
+            max_loots = std::max(max_loots, session.GetLoots().size());
+        }
+
+        REQUIRE(max_loots == DOGS_COUNT);
+
+        WHEN("it keeps ticking and publishing snapshots in the steady state") {
+            const auto first_loot_id = session.GetNextLootId();
+            const size_t before = allocations_count.load();
+
+            bool gathered = false;
+            for (int i = 0; i < 200; ++i) {
+                const size_t loots_before = session.GetLoots().size();
+                session.Tick(TICK);
+                session.PublishSnapshot();
+                gathered = gathered || session.GetLoots().size() < loots_before;
+            }
+
+            const size_t after = allocations_count.load();
+
+            THEN("loot is spawned and gathered") {
+                CHECK(session.GetNextLootId() > first_loot_id);
+                CHECK(gathered);
+            }
+
+            THEN("no memory is allocated") {
+                CHECK(after == before);
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/program_options/errors.hpp>
+
+#include "../src/server/command_line.h"
+
+using namespace std::literals;
+
+SCENARIO("List of cpus for the tick thread") {
+    using Cpus = std::vector<unsigned>;
+    using Error = boost::program_options::validation_error;
+
+    GIVEN("valid lists") {
+        THEN("single cpus and ranges are expanded in order") {
+            CHECK(util::ParseCpuList("2,3"s) == Cpus{2, 3});
+            CHECK(util::ParseCpuList("2-5"s) == Cpus{2, 3, 4, 5});
+            CHECK(util::ParseCpuList("0,2-3,6"s) == Cpus{0, 2, 3, 6});
+            CHECK(util::ParseCpuList("7-7"s) == Cpus{7});
+        }
+    }
+
+    GIVEN("invalid lists") {
+        THEN("reversed ranges and garbage are rejected") {
+            CHECK_THROWS_AS(util::ParseCpuList("5-2"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("a"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("2,"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList(""s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("-3"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("1-2-3"s), Error);
+        }
+
+        THEN("cpus out of range are rejected before the list is built") {
+            CHECK_THROWS_AS(util::ParseCpuList("0-4294967295"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("2-100000000"s), Error);
+            CHECK_THROWS_AS(util::ParseCpuList("4294967296"s), Error);
+        }
+    }
+}
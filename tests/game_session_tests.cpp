@@ -0,0 +1,797 @@
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../src/game/model.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Map MakeMap() {
+
+    model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3};
+
+    map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+    map.BuildRoadGraph();
+    map.AddLoot(10);
+
+    return map;
+}
+
+//
+//  В фиксированной точке край дороги округляется внутрь дороги,
+//  т.е. не дальше, чем на 1/1024
+//
+bool IsAtEdge(const geom::Point2D& pos, const geom::Point2D& edge) {
+#ifdef GAME_FIXED_POINT_COORDS
+    constexpr double UNIT = 1.0 / geom::fixed::ONE;
+    return std::abs(pos.x - edge.x) < UNIT && std::abs(pos.y - edge.y) < UNIT;
+#else
+    return pos == edge;
+#endif
+}
+
+}  // namespace
+
+SCENARIO("Dogs removal") {
+    GIVEN("a session with three dogs") {
+        const auto map = MakeMap();
+        model::GameSession session{map, 1s, 0.5};
+
+        const auto first = session.AddDog("first"s, false).GetId();
+        const auto second = session.AddDog("second"s, false).GetId();
+        const auto third = session.AddDog("third"s, false).GetId();
+
+        const auto first_handle = session.FindDogHandle(first);
+        const auto second_handle = session.FindDogHandle(second);
+        const auto third_handle = session.FindDogHandle(third);
+
+        REQUIRE(first_handle);
+        REQUIRE(second_handle);
+        REQUIRE(third_handle);
+
+        WHEN("a dog is removed") {
+            session.RemoveDog(first);
+
+            THEN("it can be found neither by id nor by handle") {
+                CHECK(session.GetDogs().size() == 2);
+                CHECK(!session.FindDog(first));
+                CHECK(!session.FindDog(*first_handle));
+            }
+
+            THEN("other dogs are found by id and by handle") {
+                CHECK(session.FindDog(second)->GetName() == "second"s);
+                CHECK(session.FindDog(third)->GetName() == "third"s);
+                CHECK(session.FindDog(*second_handle)->GetName() == "second"s);
+                CHECK(session.FindDog(*third_handle)->GetName() == "third"s);
+            }
+
+            AND_WHEN("a new dog takes the freed place") {
+                const auto fourth = session.AddDog("fourth"s, false).GetId();
+
+                THEN("the old handle stays invalid") {
+                    CHECK(!session.FindDog(*first_handle));
+                    CHECK(session.FindDog(*session.FindDogHandle(fourth))->GetName() == "fourth"s);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Dog bag") {
+    GIVEN("maps with a small and with a large bag") {
+        model::Map small_map{model::Map::Id{"small"s}, "Small"s, 1.0, 3};
+        small_map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        small_map.BuildRoadGraph();
+
+        constexpr size_t LARGE_CAPACITY = model::Dog::INLINE_BAG_CAPACITY + 2;
+        model::Map large_map{model::Map::Id{"large"s}, "Large"s, 1.0, LARGE_CAPACITY};
+        large_map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        large_map.BuildRoadGraph();
+
+        model::GameSession small_session{small_map, 1s, 0.5};
+        model::GameSession large_session{large_map, 1s, 0.5};
+
+        auto small_dog = small_session.AddDog("small"s, false);
+        auto large_dog = large_session.AddDog("large"s, false);
+
+        WHEN("dogs gather loot") {
+            for (model::Loot::Id id = 0; id < 10; ++id) {
+                small_dog.TryGatherLoot({id, 0, 10});
+                large_dog.TryGatherLoot({id, 0, 10});
+            }
+
+            THEN("bags are filled up to their capacity") {
+                CHECK(small_dog.GetBag().size() == 3);
+                CHECK(small_dog.GetBag().capacity() == model::Dog::INLINE_BAG_CAPACITY);
+                CHECK(large_dog.GetBag().size() == LARGE_CAPACITY);
+
+                const auto copy = large_dog.GetBag();
+                CHECK(copy == large_dog.GetBag());
+                CHECK(copy[LARGE_CAPACITY - 1].id == LARGE_CAPACITY - 1);
+            }
+
+            AND_WHEN("loot is unloaded") {
+                large_dog.UnloadBag();
+
+                THEN("the bag is empty and the score is counted") {
+                    CHECK(large_dog.GetBag().empty());
+                    CHECK(large_dog.GetScore() == 10 * LARGE_CAPACITY);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Random spawn points") {
+    GIVEN("two sessions with the same random seed") {
+        auto map = MakeMap();
+        map.AddRoad({model::Road::VERTICAL, {50, 0}, 100});
+        map.BuildRoadGraph();
+
+        model::GameSession session1{map, 1s, 0.5, 42};
+        model::GameSession session2{map, 1s, 0.5, 42};
+
+        WHEN("dogs are spawned at random points and loot is generated") {
+            for (int i = 0; i < 10; ++i) {
+                session1.AddDog("dog"s, true);
+                session2.AddDog("dog"s, true);
+            }
+            session1.GenerateLoots(10s);
+            session2.GenerateLoots(10s);
+
+            THEN("both sessions have the same dogs and loot") {
+                REQUIRE(session1.GetDogs().size() == session2.GetDogs().size());
+                for (size_t i = 0; i < session1.GetDogs().size(); ++i) {
+                    CHECK(session1.GetDogs()[i].GetId() == session2.GetDogs()[i].GetId());
+                    CHECK(session1.GetDogs()[i].GetPos() == session2.GetDogs()[i].GetPos());
+                }
+
+                REQUIRE(session1.GetLoots().size() == session2.GetLoots().size());
+                for (size_t i = 0; i < session1.GetLoots().size(); ++i) {
+                    CHECK(session1.GetLoots()[i].GetType() == session2.GetLoots()[i].GetType());
+                    CHECK(session1.GetLoots()[i].GetPos() == session2.GetLoots()[i].GetPos());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Spawn points are weighted by road length") {
+    GIVEN("a map with a long and a short road") {
+        model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3};
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 900});
+        map.AddRoad({model::Road::VERTICAL, {0, 10}, 110});
+        map.BuildRoadGraph();
+        map.AddLoot(10);
+
+        model::GameSession session{map, 1s, 0.5, 42};
+
+        WHEN("many dogs are spawned at random points") {
+            constexpr int DOGS = 10'000;
+            int on_short_road = 0;
+
+            for (int i = 0; i < DOGS; ++i) {
+                const auto pos = session.AddDog("dog"s, true).GetPos();
+
+                if (pos.y == 0.0) {
+                    CHECK((pos.x >= 0.0 && pos.x <= 900.0));
+                }
+                else {
+                    CHECK(pos.x == 0.0);
+                    CHECK((pos.y >= 10.0 && pos.y <= 110.0));
+                    ++on_short_road;
+                }
+            }
+
+            THEN("the short road gets its share by length") {
+                CHECK(on_short_road > DOGS * 8 / 100);
+                CHECK(on_short_road < DOGS * 12 / 100);
+            }
+        }
+    }
+
+    GIVEN("a spawn table with zero length roads only") {
+        model::SpawnTable table;
+        table.Build({0.0, 0.0});
+
+        THEN("roads are chosen uniformly") {
+            CHECK(table.Draw(0).index == 0);
+            CHECK(table.Draw(0xFFFFFFFF'FFFFFFFFull).index == 1);
+        }
+    }
+}
+
+SCENARIO("Random seed of the game") {
+    GIVEN("games with the same and with a different random seed") {
+        auto make_game = [](model::GameSession::Seed seed) {
+            auto game = std::make_shared<model::Game>(1s, 0.5, 1min);
+            game->SetRandomSeed(seed);
+
+            auto map = MakeMap();
+            map.AddRoad({model::Road::VERTICAL, {50, 0}, 100});
+            map.BuildRoadGraph();
+            game->AddMap(std::move(map));
+
+            return game;
+        };
+
+        auto spawn = [](model::Game& game) {
+            auto* session = game.TakeSeat(model::Map::Id{"map"s});
+            std::vector<geom::Point2D> points;
+            for (int i = 0; i < 10; ++i) {
+                points.push_back(session->AddDog("dog"s, true).GetPos());
+            }
+            return points;
+        };
+
+        auto game1 = make_game(7);
+        auto game2 = make_game(7);
+        auto game3 = make_game(8);
+
+        THEN("the same seed gives the same world") {
+            const auto points = spawn(*game1);
+            CHECK(points == spawn(*game2));
+            CHECK(points != spawn(*game3));
+        }
+    }
+}
+
+SCENARIO("Sessions of one map") {
+    GIVEN("a map with two dogs per session") {
+        auto game = std::make_shared<model::Game>(1s, 0.5, 1min);
+
+        model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3, 2};
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        map.BuildRoadGraph();
+        game->AddMap(std::move(map));
+
+        const model::Map::Id id{"map"s};
+
+        WHEN("three players join") {
+            auto* first = game->TakeSeat(id);
+            auto* second = game->TakeSeat(id);
+            auto* third = game->TakeSeat(id);
+
+            THEN("the third one gets a new session") {
+                REQUIRE(first);
+                CHECK(first == second);
+                CHECK(third != first);
+                CHECK(game->GetSessions() == model::Game::SessionsList{first, third});
+            }
+
+            AND_WHEN("a player leaves the first session") {
+                game->FreeSeat(*first);
+
+                THEN("new players go to the least loaded sessions") {
+                    CHECK(game->TakeSeat(id) == first);
+                    CHECK(game->TakeSeat(id) == third);
+                    CHECK(game->GetSessions().size() == 2);
+                }
+            }
+        }
+
+        THEN("an unknown map has no sessions") {
+            CHECK(game->TakeSeat(model::Map::Id{"unknown"s}) == nullptr);
+        }
+    }
+}
+
+SCENARIO("Fixed point coordinates") {
+    GIVEN("points on the map") {
+        const geom::Point2D on_grid{12.5, -3.25};
+        const geom::Point2D edge{20.4, 0};
+
+        THEN("multiples of 1/1024 survive the round trip") {
+            CHECK(geom::ToReal(geom::ToFixed(on_grid)) == on_grid);
+            CHECK(geom::ToFixed(on_grid) == geom::FixedPoint2D{12800, -3328});
+        }
+
+        THEN("an edge is rounded towards the given point") {
+            const auto inside = geom::ToFixedToward(edge, geom::ToFixed(geom::Point2D{10, 0}));
+            const auto outside = geom::ToFixedToward(edge, geom::ToFixed(geom::Point2D{30, 0}));
+
+            CHECK(geom::ToReal(inside).x < edge.x);
+            CHECK(geom::ToReal(outside).x > edge.x);
+            CHECK(outside.x - inside.x == 1);
+        }
+    }
+}
+
+SCENARIO("Dog movement along the road graph") {
+    GIVEN("two joined roads on one line crossed by a vertical road") {
+        model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3};
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 10});
+        map.AddRoad({model::Road::HORIZONTAL, {10, 0}, 20});
+        map.AddRoad({model::Road::VERTICAL, {5, 0}, 10});
+        map.BuildRoadGraph();
+
+        THEN("the joined roads make one corridor") {
+            const auto& graph = map.GetRoadGraph();
+            REQUIRE(graph.Size() == 2);
+            CHECK(graph.GetRect(0).left == -0.4);
+            CHECK(graph.GetRect(0).right == 20.4);
+            CHECK(graph.GetNodes(0).size() == 1);
+        }
+
+        model::GameSession session{map, 1s, 0.};
+        const auto id = session.AddDog("dog"s, false).GetId();
+
+        WHEN("the dog runs along the line") {
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+            session.MoveDogs(15s);
+
+            THEN("it passes the joint without stopping") {
+                CHECK(session.FindDog(id)->GetPos() == geom::Point2D{15, 0});
+            }
+
+            AND_WHEN("it keeps running") {
+                session.MoveDogs(10s);
+
+                THEN("it stops at the end of the corridor") {
+                    CHECK(IsAtEdge(session.FindDog(id)->GetPos(), {20.4, 0}));
+                    CHECK(session.FindDog(id)->GetSpeed() == geom::Vec2D{0, 0});
+                }
+            }
+        }
+
+        WHEN("the dog turns at the crossroad") {
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+            session.MoveDogs(5s);
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Down);
+            session.MoveDogs(3s);
+
+            THEN("it moves along the vertical road") {
+                CHECK(session.FindDog(id)->GetPos() == geom::Point2D{5, 3});
+            }
+        }
+    }
+}
+
+SCENARIO("Road choice at crossroads") {
+    GIVEN("horizontal and vertical roads overlapping at crossroads") {
+        model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3};
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 10});
+        map.AddRoad({model::Road::VERTICAL, {5, -5}, 5});
+        map.AddRoad({model::Road::HORIZONTAL, {0, -3}, 10});
+        map.AddRoad({model::Road::VERTICAL, {10, -5}, 0});
+        map.BuildRoadGraph();
+
+        const auto& graph = map.GetRoadGraph();
+        REQUIRE(graph.Size() == map.GetRoads().size());
+
+        //
+        //  прежний поиск по списку дорог: первая дорога нужного направления,
+        //  а если такой нет - последняя из содержащих точку
+        //
+        auto find_by_roads = [&graph](const geom::Point2D& pt, bool horizontal_move) {
+            auto found = model::RoadGraph::NO_CORRIDOR;
+            for (model::RoadGraph::Index idx = 0; idx < graph.Size(); ++idx) {
+                if (!graph.GetRect(idx).Test(pt)) {
+                    continue;
+                }
+                if (graph.IsHorizontal(idx) == horizontal_move) {
+                    return idx;
+                }
+                found = idx;
+            }
+            return found;
+        };
+
+        THEN("at the crossroad the road along the move is chosen") {
+            CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, {5, 0}, true) == 0);
+            CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, {5, 0}, false) == 1);
+            CHECK(graph.Locate(1, {5, -3}, true) == 2);
+            CHECK(graph.Locate(2, {5, -3}, false) == 1);
+            CHECK(graph.Locate(2, {10, -3}, false) == 3);
+        }
+
+        THEN("off the crossroad the dog stays on its only road") {
+            CHECK(graph.Locate(1, {5, 2}, true) == 1);
+            CHECK(graph.Locate(0, {2, 0}, false) == 0);
+        }
+
+        THEN("every point matches the road list lookup for both directions and any hint") {
+            for (int y = -55; y <= 55; ++y) {
+                for (int x = -5; x <= 105; ++x) {
+                    const geom::Point2D pt{x / 10., y / 10.};
+                    for (bool horizontal_move : {true, false}) {
+                        const auto expected = find_by_roads(pt, horizontal_move);
+                        CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, pt, horizontal_move) == expected);
+                        for (model::RoadGraph::Index hint = 0; hint < graph.Size(); ++hint) {
+                            if (graph.GetRect(hint).Test(pt)) {
+                                CHECK(graph.Locate(hint, pt, horizontal_move) == expected);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Road choice among overlapping parallel corridors") {
+    GIVEN("a horizontal road crossed by two overlapping vertical roads") {
+        model::RoadGraph graph;
+        graph.Build({
+            {true, 0, 0, 10},
+            {false, 5, 0, 10},
+            {false, 5.5, 0, 10}}, 0.4);
+
+        const geom::Point2D both_vertical{5.2, 5};
+        const geom::Point2D all_three{5.2, 0};
+
+        THEN("moving across them the last one in road order is chosen") {
+            CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, both_vertical, true) == 2);
+            CHECK(graph.Locate(1, both_vertical, true) == 2);
+            CHECK(graph.Locate(2, both_vertical, true) == 2);
+        }
+
+        THEN("moving along them the first one in road order is chosen") {
+            CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, both_vertical, false) == 1);
+            CHECK(graph.Locate(1, both_vertical, false) == 1);
+            CHECK(graph.Locate(2, both_vertical, false) == 1);
+            CHECK(graph.Locate(0, all_three, false) == 1);
+        }
+
+        THEN("the matching road wins at the crossroad") {
+            CHECK(graph.Locate(model::RoadGraph::NO_CORRIDOR, all_three, true) == 0);
+            CHECK(graph.Locate(2, all_three, true) == 0);
+        }
+    }
+}
+
+SCENARIO("Dog motion between ticks") {
+    GIVEN("a session with a dog on a road of length 100") {
+        const auto map = MakeMap();
+        model::GameSession session{map, 1s, 0.};
+        const auto id = session.AddDog("dog"s, false).GetId();
+
+        WHEN("the dog stands still") {
+            session.MoveDogs(2s);
+            session.MoveDogs(1s);
+
+            THEN("it is idle all the time") {
+                CHECK(session.FindDog(id)->GetIdleTime() == 3s);
+                CHECK(session.FindDog(id)->GetPlayTime() == 3s);
+                CHECK(session.GetDogs().MovingCount() == 0);
+            }
+        }
+
+        WHEN("the dog runs to the end of the road") {
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+            session.MoveDogs(60s);
+            session.MoveDogs(60s);
+
+            THEN("it stops at the edge and is idle only after the tick it stopped in") {
+                CHECK(IsAtEdge(session.FindDog(id)->GetPos(), {100.4, 0}));
+                CHECK(session.FindDog(id)->GetIdleTime() == 0s);
+                CHECK(session.GetDogs().MovingCount() == 0);
+
+                session.MoveDogs(5s);
+                CHECK(session.FindDog(id)->GetIdleTime() == 5s);
+                CHECK(session.FindDog(id)->GetPlayTime() == 125s);
+            }
+        }
+
+        WHEN("another moving dog is removed") {
+            const auto other = session.AddDog("other"s, false).GetId();
+            session.FindDog(other)->ChangeDir(model::Dog::Direction::Right);
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+            session.RemoveDog(other);
+
+            THEN("the remaining dog keeps moving") {
+                const auto gatherers = session.MoveDogs(10s);
+                REQUIRE(gatherers.size() == 1);
+                CHECK(gatherers.front().id == id);
+                CHECK(session.FindDog(id)->GetPos() == geom::Point2D{10, 0});
+            }
+        }
+    }
+}
+
+SCENARIO("Player actions") {
+    GIVEN("a session with a dog") {
+        const auto map = MakeMap();
+        model::GameSession session{map, 1s, 0.};
+        const auto id = session.AddDog("dog"s, false).GetId();
+        const auto handle = *session.FindDogHandle(id);
+
+        WHEN("an action is posted") {
+            REQUIRE(session.PostAction(handle, model::Dog::Direction::Right));
+
+            THEN("it is applied only by the next tick") {
+                CHECK(session.FindDog(id)->GetDir() == model::Dog::Direction::Up);
+
+                session.Tick(10s);
+                CHECK(session.FindDog(id)->GetDir() == model::Dog::Direction::Right);
+                CHECK(session.FindDog(id)->GetPos() == geom::Point2D{10, 0});
+            }
+        }
+
+        WHEN("the dog leaves before the tick") {
+            REQUIRE(session.PostAction(handle, model::Dog::Direction::Right));
+            session.RemoveDog(id);
+            const auto other = session.AddDog("other"s, false).GetId();
+
+            THEN("its action is dropped and does not reach the dog in its slot") {
+                session.Tick(10s);
+                CHECK(session.FindDog(other)->GetSpeed() == geom::Vec2D{0, 0});
+            }
+        }
+
+        WHEN("the queue is full") {
+            for (size_t i = 0; i < model::GameSession::ACTION_QUEUE_CAPACITY; ++i) {
+                REQUIRE(session.PostAction(handle, model::Dog::Direction::Left));
+            }
+
+            THEN("further actions are rejected until the tick") {
+                CHECK(!session.PostAction(handle, model::Dog::Direction::Right));
+
+                session.ApplyActions();
+                CHECK(session.PostAction(handle, model::Dog::Direction::Right));
+            }
+        }
+    }
+}
+
+SCENARIO("Session snapshots") {
+    GIVEN("a session with a running dog") {
+        const auto map = MakeMap();
+        model::GameSession session{map, 1s, 0.};
+        const auto id = session.AddDog("dog"s, false).GetId();
+        session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+        session.PublishSnapshot();
+
+        auto before = session.GetSnapshot();
+        REQUIRE(before->dogs.size() == 1);
+        REQUIRE(before->players->size() == 1);
+        CHECK(before->players->front().name == "dog"s);
+
+        WHEN("the session ticks and publishes a new snapshot") {
+            session.Tick(10s);
+            session.PublishSnapshot();
+            const auto after = session.GetSnapshot();
+
+            THEN("a reader of the old snapshot still sees the old state") {
+                CHECK(before->dogs.front().pos == geom::Point2D{0, 0});
+                CHECK(after->dogs.front().pos == geom::Point2D{10, 0});
+            }
+
+            THEN("the list of players is shared while nobody joins or leaves") {
+                CHECK(after->players == before->players);
+                CHECK(after->players_generation == before->players_generation);
+            }
+
+            THEN("it gets the next generation") {
+                CHECK(after->generation == before->generation + 1);
+            }
+
+            AND_WHEN("the old snapshot is released") {
+                const auto* old = before.get();
+                before.reset();
+
+                std::set<const model::SessionSnapshot*> used;
+                bool reused = false;
+                for (size_t i = 0; i < 3 * model::GameSession::SNAPSHOT_HISTORY; ++i) {
+                    session.Tick(100ms);
+                    session.PublishSnapshot();
+                    used.insert(session.GetSnapshot().get());
+                    reused = reused || session.GetSnapshot().get() == old;
+                }
+
+                THEN("it is reused once it leaves the history") {
+                    CHECK(reused);
+                    CHECK(used.size() <= model::GameSession::SNAPSHOT_HISTORY + 2);
+                }
+            }
+        }
+
+        WHEN("a dog moves, another joins and loot is picked up") {
+            model::Loot::Id next_loot_id = 1;
+            model::GameSession::Loots loots;
+            loots.emplace_back({next_loot_id++, 0, 10, {5, 0}});
+            loots.emplace_back({next_loot_id++, 1, 10, {0, 100}});
+            session.SetLoots(std::move(loots), next_loot_id);
+            const auto base = session.GetSnapshot();
+
+            const auto other = session.AddDog("other"s, false).GetId();
+            session.Tick(10s);
+            session.PublishSnapshot();
+            const auto current = session.GetSnapshot();
+
+            THEN("the delta holds only what changed since the base snapshot") {
+                const auto delta = current->MakeDelta(*base);
+
+                REQUIRE(delta.dogs.size() == 2);
+                CHECK(delta.dogs[0]->id == id);
+                CHECK(delta.dogs[0]->pos == geom::Point2D{10, 0});
+                CHECK(delta.dogs[1]->id == other);
+                CHECK(delta.removed_dogs.empty());
+
+                CHECK(delta.loots.empty());
+                REQUIRE(delta.removed_loots.size() == 1);
+                CHECK(delta.removed_loots.front() == 1);
+            }
+
+            THEN("a snapshot has no changes against itself") {
+                const auto delta = current->MakeDelta(*current);
+                CHECK(delta.dogs.empty());
+                CHECK(delta.removed_dogs.empty());
+                CHECK(delta.loots.empty());
+                CHECK(delta.removed_loots.empty());
+            }
+
+            THEN("the base snapshot is found while it is in the history") {
+                CHECK(session.FindSnapshot(base->generation) == base);
+                CHECK(session.FindSnapshot(current->generation + 1) == nullptr);
+
+                for (size_t i = 0; i < model::GameSession::SNAPSHOT_HISTORY; ++i) {
+                    session.Tick(100ms);
+                    session.PublishSnapshot();
+                }
+                CHECK(session.FindSnapshot(base->generation) == nullptr);
+            }
+        }
+
+        WHEN("nothing changes in the session") {
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Stop);
+            session.Tick(1s);
+            session.PublishSnapshot();
+            const auto stopped = session.GetSnapshot();
+
+            session.Tick(1s);
+            session.PublishSnapshot();
+
+            THEN("no new snapshot is published and the generation stays") {
+                CHECK(session.GetSnapshot() == stopped);
+                CHECK(stopped->generation == before->generation + 1);
+            }
+        }
+
+        WHEN("several readers ask for the serialized state") {
+            int serializations = 0;
+            auto serialize = [&serializations](const model::SessionSnapshot& snapshot) {
+                ++serializations;
+                return std::to_string(snapshot.dogs.size());
+            };
+
+            const auto first = before->GetStateBody(serialize);
+            const auto second = before->GetStateBody(serialize);
+
+            THEN("the snapshot is serialized once and the body is shared") {
+                CHECK(serializations == 1);
+                CHECK(first == second);
+                CHECK(*first == "1"s);
+            }
+
+            AND_WHEN("the next snapshot is published") {
+                session.Tick(1s);
+                session.PublishSnapshot();
+                const auto next = session.GetSnapshot()->GetStateBody(serialize);
+
+                THEN("it is serialized anew") {
+                    CHECK(serializations == 2);
+                    CHECK(next != first);
+                }
+            }
+        }
+
+        WHEN("another player joins") {
+            session.AddDog("other"s, false);
+            session.PublishSnapshot();
+
+            THEN("the list of players gets the generation of the snapshot") {
+                CHECK(session.GetSnapshot()->players_generation == session.GetSnapshot()->generation);
+                CHECK(session.GetSnapshot()->players_generation > before->players_generation);
+            }
+
+            THEN("players are listed in the order they joined") {
+                const auto players = session.GetSnapshot()->players;
+                REQUIRE(players->size() == 2);
+                CHECK((*players)[0].name == "dog"s);
+                CHECK((*players)[1].name == "other"s);
+            }
+        }
+    }
+}
+
+SCENARIO("Slot map ids") {
+    GIVEN("a slot map and a swap-remove storage of its ids") {
+        model::SlotMap<std::uint64_t> slots;
+        std::vector<std::uint64_t> storage;
+        std::vector<std::uint64_t> erased;
+
+        std::uint64_t next_id = 1;
+        std::uint64_t seed = 12345;
+        auto random = [&seed](size_t bound) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            return static_cast<size_t>(seed >> 33) % bound;
+        };
+
+        WHEN("ids are inserted and erased in random order") {
+            for (int i = 0; i < 20000; ++i) {
+                if (storage.empty() || (random(3) != 0 && storage.size() < 300)) {
+                    slots.Insert(next_id);
+                    storage.push_back(next_id++);
+                }
+                else {
+                    const size_t slot = random(storage.size());
+                    slots.Erase(storage[slot], slot);
+                    erased.push_back(storage[slot]);
+                    storage[slot] = storage.back();
+                    storage.pop_back();
+                }
+            }
+
+            THEN("every live id is found in its slot and erased ids are gone") {
+                REQUIRE(slots.size() == storage.size());
+                for (size_t slot = 0; slot < storage.size(); ++slot) {
+                    CHECK(slots.Find(storage[slot]) == slot);
+                    CHECK(slots.Find(*slots.FindHandle(storage[slot])) == slot);
+                }
+                for (auto id : erased) {
+                    CHECK_FALSE(slots.Find(id));
+                }
+                CHECK_FALSE(slots.Find(next_id));
+            }
+        }
+    }
+}
+
+SCENARIO("Lock-free queue with many producers") {
+    GIVEN("a queue and four producer threads") {
+        constexpr size_t PRODUCERS = 4;
+        constexpr size_t ITEMS = 20'000;
+
+        struct Item {
+            std::uint32_t producer = 0;
+            std::uint32_t seq = 0;
+        };
+
+        util::MpscQueue<Item> queue{256};
+
+        WHEN("producers push while the consumer drains") {
+            std::vector<std::thread> producers;
+            for (std::uint32_t p = 0; p < PRODUCERS; ++p) {
+                producers.emplace_back([&queue, p] {
+                    for (std::uint32_t seq = 0; seq < ITEMS;) {
+                        if (queue.TryPush({p, seq})) {
+                            ++seq;
+                        }
+                        else {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+
+            std::array<std::uint32_t, PRODUCERS> next{};
+            size_t received = 0;
+            bool in_order = true;
+
+            while (received < PRODUCERS * ITEMS) {
+                received += queue.Drain([&](const Item& item) {
+                    in_order = in_order && (item.seq == next[item.producer]);
+                    ++next[item.producer];
+                });
+            }
+
+            for (auto& producer : producers) {
+                producer.join();
+            }
+
+            THEN("every item arrives once and in the order of its producer") {
+                CHECK(in_order);
+                for (auto count : next) {
+                    CHECK(count == ITEMS);
+                }
+                CHECK(queue.Drain([](const Item&) {}) == 0);
+            }
+        }
+    }
+}
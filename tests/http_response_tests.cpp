@@ -0,0 +1,115 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/game/model.h"
+#include "../src/server/http_response.h"
+
+using namespace std::literals;
+
+namespace {
+
+http_handler::StringRequest MakeRequest(std::string_view if_none_match) {
+    http_handler::StringRequest req{http_handler::http::verb::get, "/api/v1/game/state"sv, 11};
+    req.set(http_handler::http::field::if_none_match, if_none_match);
+    req.keep_alive(true);
+    return req;
+}
+
+//
+//  то же, что делает ApiRequestHandler: 304, если у клиента текущая версия
+//
+std::optional<http_handler::StringResponse> TryNotModified(http_handler::StringRequest&& req, const std::string& etag) {
+    if (http_handler::MatchesETag(req[http_handler::http::field::if_none_match], etag)) {
+        return http_handler::NotModifiedResponse(std::move(req), etag);
+    }
+    return std::nullopt;
+}
+
+std::string MakeETag(const model::SessionSnapshot& snapshot) {
+    return http_handler::MakeETag(snapshot.epoch, snapshot.generation);
+}
+
+}  // namespace
+
+SCENARIO("ETag matching") {
+    GIVEN("an ETag") {
+        const auto etag = http_handler::MakeETag(7, 42);
+
+        THEN("it is a quoted epoch and version") {
+            CHECK(etag == "\"7-42\""s);
+        }
+
+        THEN("If-None-Match matches the same tag, a weak one, a list with it and *") {
+            CHECK(http_handler::MatchesETag("\"7-42\""sv, etag));
+            CHECK(http_handler::MatchesETag("W/\"7-42\""sv, etag));
+            CHECK(http_handler::MatchesETag("\"1-1\", \"7-42\" "sv, etag));
+            CHECK(http_handler::MatchesETag("*"sv, etag));
+        }
+
+        THEN("other versions, other epochs and an empty header do not match") {
+            CHECK_FALSE(http_handler::MatchesETag("\"7-41\""sv, etag));
+            CHECK_FALSE(http_handler::MatchesETag("\"8-42\""sv, etag));
+            CHECK_FALSE(http_handler::MatchesETag("\"42\""sv, etag));
+            CHECK_FALSE(http_handler::MatchesETag(""sv, etag));
+        }
+
+        WHEN("a 304 response is made") {
+            const auto response = http_handler::NotModifiedResponse(MakeRequest(etag), etag);
+
+            THEN("it has the ETag and no body") {
+                CHECK(response.result() == http_handler::http::status::not_modified);
+                CHECK(response[http_handler::http::field::etag] == etag);
+                CHECK(response[http_handler::http::field::cache_control] == "no-cache"sv);
+                CHECK(response.body().empty());
+                CHECK(response.version() == 11);
+                CHECK(response.keep_alive());
+            }
+        }
+    }
+}
+
+SCENARIO("Not modified game state") {
+    GIVEN("a session with a dog") {
+        model::Map map{model::Map::Id{"map"s}, "Map"s, 1.0, 3};
+        map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 100});
+        map.BuildRoadGraph();
+
+        model::GameSession session{map, 1s, 0.};
+        const auto id = session.AddDog("dog"s, false).GetId();
+        session.PublishSnapshot();
+
+        const auto etag = MakeETag(*session.GetSnapshot());
+
+        WHEN("nothing changes") {
+            session.Tick(1s);
+            session.PublishSnapshot();
+
+            THEN("the client with the last ETag gets 304") {
+                const auto response = TryNotModified(MakeRequest(etag), MakeETag(*session.GetSnapshot()));
+                REQUIRE(response);
+                CHECK(response->result() == http_handler::http::status::not_modified);
+            }
+        }
+
+        WHEN("the dog moves") {
+            session.FindDog(id)->ChangeDir(model::Dog::Direction::Right);
+            session.Tick(1s);
+            session.PublishSnapshot();
+
+            THEN("the client gets the new state") {
+                CHECK_FALSE(TryNotModified(MakeRequest(etag), MakeETag(*session.GetSnapshot())));
+            }
+        }
+
+        WHEN("another session reaches the same generation") {
+            model::GameSession other{map, 1s, 0.};
+            other.AddDog("dog"s, false);
+            other.PublishSnapshot();
+            REQUIRE(other.GetSnapshot()->generation == session.GetSnapshot()->generation);
+
+            THEN("its ETag differs") {
+                CHECK(other.GetSnapshot()->epoch != session.GetSnapshot()->epoch);
+                CHECK_FALSE(TryNotModified(MakeRequest(etag), MakeETag(*other.GetSnapshot())));
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <limits>
+
+#include "../src/server/json_writer.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::string FormatDouble(double value) {
+    char buffer[json_serializer::JsonWriter::MAX_DOUBLE_LENGTH];
+    return {buffer, json_serializer::JsonWriter::FormatDouble(buffer, value)};
+}
+
+}  // namespace
+
+SCENARIO("Streaming JSON writer") {
+    GIVEN("a writer") {
+        json_serializer::JsonWriter writer;
+
+        WHEN("nested objects and arrays are written") {
+            writer.BeginObject();
+            writer.Key("players"sv).BeginObject();
+            writer.Key(std::uint64_t{1}).BeginObject().Key("name"sv).String("dog"sv).EndObject();
+            writer.Key(std::uint64_t{20}).BeginObject().EndObject();
+            writer.EndObject();
+            writer.Key("pos"sv).BeginArray().Int(-2).UInt(3).Double(1.5).EndArray();
+            writer.Key("bag"sv).BeginArray().EndArray();
+            writer.Key("raw"sv).Raw(R"({"a":1})"sv);
+            writer.EndObject();
+
+            THEN("commas are placed between elements and there are no spaces") {
+                CHECK(writer.Release() ==
+                      R"({"players":{"1":{"name":"dog"},"20":{}},"pos":[-2,3,1.5E0],"bag":[],"raw":{"a":1}})"s);
+            }
+        }
+
+        WHEN("a string with special characters is written") {
+            writer.String("a\"b\\c\n\t\x01/\xD0\xAF"sv);
+
+            THEN("it is escaped the way boost::json does it") {
+                CHECK(writer.Release() == "\"a\\\"b\\\\c\\n\\t\\u0001/\xD0\xAF\""s);
+            }
+        }
+    }
+}
+
+SCENARIO("Shortest round-trip doubles in boost::json format") {
+    CHECK(FormatDouble(10.0) == "1E1"s);
+    CHECK(FormatDouble(1.5) == "1.5E0"s);
+    CHECK(FormatDouble(0.4) == "4E-1"s);
+    CHECK(FormatDouble(123.456) == "1.23456E2"s);
+    CHECK(FormatDouble(-0.25) == "-2.5E-1"s);
+    CHECK(FormatDouble(0.0) == "0E0"s);
+    CHECK(FormatDouble(-0.0) == "-0E0"s);
+    CHECK(FormatDouble(0.1 + 0.2) == "3.0000000000000004E-1"s);
+    CHECK(FormatDouble(5e-324) == "5E-324"s);
+    CHECK(FormatDouble(std::numeric_limits<double>::max()) == "1.7976931348623157E308"s);
+    CHECK(FormatDouble(std::numeric_limits<double>::infinity()) == "Infinity"s);
+}
@@ -1,6 +1,8 @@
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <set>
 #include <sstream>
 
 #include "../src/game/model.h"
@@ -18,6 +20,40 @@ struct Fixture {
     OutputArchive output_archive{strm};
 };
 
+const Map::Id MAP_ID{"map"s};
+
+//
+//  игра с одной картой, в сессию которой помещается max_dogs собак
+//
+Game::Ptr MakeGame(size_t max_dogs) {
+
+    auto game = std::make_shared<Game>(1s, 0.0, 60s);
+
+    Map map{MAP_ID, "Map"s, 1.0, 3, max_dogs};
+    map.AddRoad({Road::HORIZONTAL, {0, 0}, 100});
+    map.BuildRoadGraph();
+    map.AddLoot(10);
+    game->AddMap(std::move(map));
+
+    return game;
+}
+
+//
+//  игрок в формате файлов версии 0 - без номера сессии
+//
+struct PlayerReprV0 {
+    app::Token token{""s};
+    app::Player::Id player_id{0};
+    Map::Id map_id{""s};
+
+    template <typename Archive>
+    void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
+        ar& token;
+        ar& player_id;
+        ar& map_id;
+    }
+};
+
 }  // namespace
 
 SCENARIO_METHOD(Fixture, "Point serialization") {
@@ -65,3 +101,129 @@ SCENARIO_METHOD(Fixture, "Dog Serialization") {
         }
     }
 }
+
+SCENARIO_METHOD(Fixture, "Game state with several sessions of one map") {
+    GIVEN("a map with two sessions: a full one and one with a free seat") {
+        const auto game = MakeGame(2);
+        app::Players players;
+
+        std::map<std::string, size_t> token_sessions;
+        for (size_t i = 0; i < 3; ++i) {
+            auto* session = game->TakeSeat(MAP_ID);
+            const auto id = session->AddDog("dog"s + std::to_string(i), false).GetId();
+            const app::Token token{"token"s + std::to_string(i)};
+            players.AddPlayer(token, *session, id);
+        }
+
+        const auto sessions = game->GetSessions();
+        REQUIRE(sessions.size() == 2);
+        REQUIRE(sessions[0]->GetDogs().size() == 2);
+        REQUIRE(sessions[1]->GetDogs().size() == 1);
+
+        WHEN("the state is saved as SaveGameState does it") {
+            {
+                std::vector<serialization::SessionRepr> session_reprs;
+                std::vector<serialization::PlayerRepr> player_reprs;
+
+                for (size_t index = 0; index < sessions.size(); ++index) {
+                    session_reprs.emplace_back(*sessions[index]);
+                    for (const auto& pair : players.GetPairs(*sessions[index])) {
+                        player_reprs.emplace_back(pair, index);
+                        token_sessions[*pair.first] = index;
+                    }
+                }
+
+                output_archive << session_reprs;
+                output_archive << player_reprs;
+            }
+
+            AND_WHEN("it is restored into a new game") {
+                const auto restored_game = MakeGame(2);
+                app::Players restored_players;
+
+                serialization::RestoreGameState(strm, restored_game, [&restored_players](app::Token token, app::Player&& player) {
+                    restored_players.AddPlayer(std::move(token), std::move(player));
+                });
+
+                const auto restored_sessions = restored_game->GetSessions();
+
+                THEN("every saved session is restored into its own instance") {
+                    REQUIRE(restored_sessions.size() == 2);
+                    CHECK(restored_sessions[0]->GetDogs().size() == 2);
+                    CHECK(restored_sessions[1]->GetDogs().size() == 1);
+                }
+
+                THEN("every token is restored into the instance it was saved from") {
+                    REQUIRE(restored_sessions.size() == 2);
+                    REQUIRE(token_sessions.size() == 3);
+                    for (const auto& [token, index] : token_sessions) {
+                        const auto* session = restored_players.FindSession(app::Token{token});
+                        REQUIRE(session != nullptr);
+                        CHECK(session == restored_sessions[index]);
+                        CHECK(restored_players.GetPairs(*session).size() == session->GetDogs().size());
+                    }
+                }
+
+                THEN("the seats are taken by the restored dogs") {
+                    //
+                    //  в первой сессии мест нет, во второй - одно
+                    //
+                    CHECK(restored_game->TakeSeat(MAP_ID) == restored_sessions[1]);
+                    CHECK(restored_game->GetSessions().size() == 2);
+
+                    auto* opened = restored_game->TakeSeat(MAP_ID);
+                    CHECK(opened != restored_sessions[0]);
+                    CHECK(opened != restored_sessions[1]);
+                    CHECK(restored_game->GetSessions().size() == 3);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Game state saved in version 0") {
+    GIVEN("a version 0 archive with one session and players without a session index") {
+        const auto game = MakeGame(0);
+        auto* session = game->TakeSeat(MAP_ID);
+        game->TakeSeat(MAP_ID);
+        const auto first = session->AddDog("first"s, false).GetId();
+        const auto second = session->AddDog("second"s, false).GetId();
+
+        {
+            std::vector<serialization::SessionRepr> session_reprs;
+            session_reprs.emplace_back(*session);
+
+            const std::vector<PlayerReprV0> player_reprs{
+                {app::Token{"first"s}, first, MAP_ID},
+                {app::Token{"second"s}, second, MAP_ID}};
+
+            output_archive << session_reprs;
+            output_archive << player_reprs;
+        }
+
+        WHEN("it is restored") {
+            const auto restored_game = MakeGame(0);
+            app::Players restored_players;
+
+            serialization::RestoreGameState(strm, restored_game, [&restored_players](app::Token token, app::Player&& player) {
+                restored_players.AddPlayer(std::move(token), std::move(player));
+            });
+
+            THEN("players are attached to the session of their map") {
+                const auto restored_sessions = restored_game->GetSessions();
+                REQUIRE(restored_sessions.size() == 1);
+
+                const auto* restored = restored_sessions.front();
+                CHECK(restored->GetDogs().size() == 2);
+                CHECK(restored_players.FindSession(app::Token{"first"s}) == restored);
+                CHECK(restored_players.FindSession(app::Token{"second"s}) == restored);
+
+                std::set<app::Player::Id> ids;
+                for (const auto& [token, player] : restored_players.GetPairs(*restored)) {
+                    ids.insert(player->GetId());
+                }
+                CHECK(ids == std::set<app::Player::Id>{first, second});
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <iterator>
+#include <string>
+
+#include "../src/game/model.h"
+
+//
+//  Карты и сессии, общие для тестов и бенчмарков
+//
+namespace test_maps {
+
+using namespace std::literals;
+
+constexpr model::Coord BLOCK_SIZE = 100;
+
+//
+//  Карта в виде сетки blocks x blocks кварталов со стороной BLOCK_SIZE,
+//  с двумя видами трофеев и офисом на перекрестке в середине карты
+//
+inline model::Map MakeCityMap(model::Coord blocks, double dog_speed) {
+
+    model::Map map{model::Map::Id{"city"s}, "City"s, dog_speed, 3};
+
+    const model::Coord size = blocks * BLOCK_SIZE;
+    for (model::Coord i = 0; i <= size; i += BLOCK_SIZE) {
+        map.AddRoad({model::Road::HORIZONTAL, {0, i}, size});
+        map.AddRoad({model::Road::VERTICAL, {i, 0}, size});
+    }
+    map.BuildRoadGraph();
+
+    map.AddLoot(10);
+    map.AddLoot(30);
+
+    const model::Coord center = blocks / 2 * BLOCK_SIZE;
+    map.AddOffice({model::Office::Id{"o0"s}, {center, center}, {0, 0}});
+
+    return map;
+}
+
+//
+//  count собак в случайных точках карты, бегущих во все четыре стороны по очереди
+//
+inline void AddRunningDogs(model::GameSession& session, size_t count) {
+
+    static constexpr model::Dog::Direction DIRECTIONS[] = {
+        model::Dog::Direction::Left,
+        model::Dog::Direction::Right,
+        model::Dog::Direction::Up,
+        model::Dog::Direction::Down
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        session.AddDog("dog"s + std::to_string(i), true).ChangeDir(DIRECTIONS[i % std::size(DIRECTIONS)]);
+    }
+}
+
+}  // namespace test_maps
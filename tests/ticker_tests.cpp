@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "../src/game/ticker.h"
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::chrono::milliseconds PERIOD = 20ms;
+
+//
+//  Запускает тикер, у которого первый тик длится 3.5 периода,
+//  и собирает дельты первых ticks_count тиков
+//
+std::vector<std::chrono::milliseconds> RunSlowFirstTick(model::TickerSettings settings, size_t ticks_count,
+                                                        model::Ticker::Stats& stats) {
+
+    model::net::io_context ioc;
+    auto strand = model::net::make_strand(ioc);
+
+    std::vector<std::chrono::milliseconds> deltas;
+
+    auto ticker = std::make_shared<model::Ticker>(strand, PERIOD, [&](std::chrono::milliseconds delta) {
+        deltas.push_back(delta);
+        if (deltas.size() == 1) {
+            std::this_thread::sleep_for(PERIOD * 3 + PERIOD / 2);
+        }
+        if (deltas.size() == ticks_count) {
+            ioc.stop();
+        }
+    }, settings);
+
+    ticker->Start();
+    ioc.run();
+
+    stats = ticker->GetStats();
+    return deltas;
+}
+
+}  // namespace
+
+SCENARIO("Ticker overload policies") {
+    GIVEN("a ticker whose first tick takes three and a half periods") {
+        model::Ticker::Stats stats;
+
+        WHEN("the policy is catch-up") {
+            const auto deltas = RunSlowFirstTick({model::OverloadPolicy::CatchUp}, 2, stats);
+
+            THEN("the next tick covers all the missed periods at once") {
+                REQUIRE(deltas.size() == 2);
+                CHECK(deltas[0] == PERIOD);
+                CHECK(deltas[1] >= PERIOD * 3);
+                CHECK(deltas[1] % PERIOD == 0ms);
+                CHECK(stats.missed_deadlines >= 2);
+                CHECK(stats.shed_periods == 0);
+            }
+        }
+
+        WHEN("the policy is multi-step capped by two steps") {
+            const auto deltas = RunSlowFirstTick({model::OverloadPolicy::MultiStep, 2}, 3, stats);
+
+            THEN("missed periods are replayed by regular ticks, the rest is shed") {
+                REQUIRE(deltas.size() == 3);
+                for (auto delta : deltas) {
+                    CHECK(delta == PERIOD);
+                }
+                CHECK(stats.missed_deadlines >= 2);
+                CHECK(stats.shed_periods == stats.missed_deadlines - 1);
+            }
+        }
+
+        WHEN("the policy is shed") {
+            const auto deltas = RunSlowFirstTick({model::OverloadPolicy::Shed}, 2, stats);
+
+            THEN("missed periods are dropped and reported") {
+                REQUIRE(deltas.size() == 2);
+                CHECK(deltas[1] == PERIOD);
+                CHECK(stats.missed_deadlines >= 2);
+                CHECK(stats.shed_periods == stats.missed_deadlines);
+            }
+        }
+
+        THEN("the slow tick and the late wake-up after it land in the longest buckets") {
+            RunSlowFirstTick({model::OverloadPolicy::Shed}, 2, stats);
+
+            //
+            //  на загруженной машине в последние корзины могут попасть
+            //  и другие тики, поэтому проверяется только нижняя граница
+            //
+            CHECK(stats.ticks == 2);
+            CHECK(std::accumulate(stats.durations.begin(), stats.durations.end(), std::uint64_t{0}) == stats.ticks);
+            CHECK(stats.durations.back() >= 1);
+            CHECK(stats.max_duration >= PERIOD * 3);
+            CHECK(stats.lateness.back() >= 1);
+        }
+    }
+}